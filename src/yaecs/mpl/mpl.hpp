@@ -2,6 +2,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <utility>
 
 namespace yaecs{
 namespace mpl{
@@ -14,6 +15,14 @@ namespace mpl{
 template<typename... Ts>
 struct type_list {};
 
+/**
+ * @brief Carries a type as a value, used to pass types into generic lambdas
+ * 
+ * @tparam T 
+ */
+template<typename T>
+struct type_identity { using type = T; };
+
 namespace detail{
 
     template<typename seq>
@@ -39,6 +48,69 @@ namespace detail{
     template<typename T, template <typename...> class seq, typename... Ts>
     struct contains_impl<T, seq<Ts...>> : std::disjunction<std::is_same<T, Ts>...> {};
 
+    template<typename... seqs>
+    struct concat_impl;
+
+    template<>
+    struct concat_impl<>{
+        using type = type_list<>;
+    };
+
+    template<template <typename...> class seq, typename... Ts>
+    struct concat_impl<seq<Ts...>>{
+        using type = type_list<Ts...>;
+    };
+
+    template<template <typename...> class seq1, typename... Ts, template <typename...> class seq2, typename... Us, typename... rest>
+    struct concat_impl<seq1<Ts...>, seq2<Us...>, rest...>{
+        using type = typename concat_impl<type_list<Ts..., Us...>, rest...>::type;
+    };
+
+    template<typename seq>
+    struct for_each_type_impl;
+
+    template<template <typename...> class seq, typename... Ts>
+    struct for_each_type_impl<seq<Ts...>>{
+        template<class callable>
+        static constexpr void apply(callable&& c){
+            (c(type_identity<Ts>{}), ...);
+        }
+    };
+
+    template<typename F, typename = void>
+    struct callable_args_impl{
+        constexpr static bool known = false;
+    };
+
+    template<typename R, typename... Args>
+    struct callable_args_impl<R(*)(Args...), void>{
+        constexpr static bool known = true;
+        using type = type_list<Args...>;
+    };
+
+    template<typename R, typename... Args>
+    struct callable_args_impl<R(*)(Args...) noexcept, void> : callable_args_impl<R(*)(Args...)>{};
+
+    template<typename R, typename C, typename... Args>
+    struct callable_args_impl<R(C::*)(Args...), void> : callable_args_impl<R(*)(Args...)>{};
+
+    template<typename R, typename C, typename... Args>
+    struct callable_args_impl<R(C::*)(Args...) const, void> : callable_args_impl<R(*)(Args...)>{};
+
+    template<typename R, typename C, typename... Args>
+    struct callable_args_impl<R(C::*)(Args...) noexcept, void> : callable_args_impl<R(*)(Args...)>{};
+
+    template<typename R, typename C, typename... Args>
+    struct callable_args_impl<R(C::*)(Args...) const noexcept, void> : callable_args_impl<R(*)(Args...)>{};
+
+    template<typename F>
+    struct callable_args_impl<F, std::void_t<decltype(&F::operator())>> : callable_args_impl<decltype(&F::operator())>{};
+
+    template<typename... Args>
+    constexpr bool reads_only(type_list<Args...>){
+        return (... && !(std::is_lvalue_reference_v<Args> && !std::is_const_v<std::remove_reference_t<Args>>));
+    }
+
 }
 
 /**
@@ -75,5 +147,44 @@ using size_type = typename detail::size_impl<seq>::type;
 template<typename seq>
 constexpr std::size_t size_v = detail::size_impl<seq>::type::value;
 
+/**
+ * @brief Concatenates the given type lists into one type_list
+ * 
+ * @tparam seqs type_list<...>...
+ */
+template<typename... seqs>
+using concat_t = typename detail::concat_impl<seqs...>::type;
+
+/**
+ * @brief Invokes \param c with type_identity<T>{} for every T in \tparam seq, in order
+ * 
+ * @tparam seq type_list<...>
+ * @tparam callable 
+ * @param c 
+ */
+template<typename seq, class callable>
+constexpr void for_each_type(callable&& c){
+    detail::for_each_type_impl<seq>::apply(std::forward<callable>(c));
+}
+
+/**
+ * @brief True if \tparam F provably never writes through its arguments: its parameter types are known and none
+ * is a non const lvalue reference
+ * 
+ * Generic lambdas and overloaded function objects are never reported as read only.
+ * 
+ * @tparam F function pointer or function object
+ */
+template<typename F>
+constexpr bool reads_only_v = []{
+    using args_ = detail::callable_args_impl<std::decay_t<F>>;
+    if constexpr(args_::known){
+        return detail::reads_only(typename args_::type{});
+    }
+    else{
+        return false;
+    }
+}();
+
 } // namespace mpl
 } // namespace yaecs
\ No newline at end of file
@@ -1,7 +1,14 @@
 #pragma once
 
 #include "mpl/mpl.hpp"
+#include "yaecs/fixed_vector.hpp"
 #include "yaecs/ec_traits.hpp"
 #include "yaecs/entity.hpp"
 #include "yaecs/component_storage.hpp"
+#include "yaecs/hierarchy.hpp"
+#include "yaecs/prefab.hpp"
+#include "yaecs/concurrent_loader.hpp"
+#include "yaecs/memory_report.hpp"
+#include "yaecs/query.hpp"
 #include "yaecs/ec_engine.hpp"
+#include "yaecs/sharded_ec_engine.hpp"
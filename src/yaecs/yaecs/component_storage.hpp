@@ -2,10 +2,246 @@
 
 #include "../mpl/mpl.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace yaecs{
 
+namespace detail{
+
+    /**
+     * @brief Makes room for \param count elements, the capacity grows at least twofold so that repeated
+     * small batches do not copy the whole container every time
+     * 
+     * @tparam Container 
+     * @param container 
+     * @param count 
+     */
+    template<class Container>
+    void reserve_geometric(Container& container, std::size_t count){
+        if(count > container.capacity()){
+            container.reserve(std::max(count, 2 * container.capacity()));
+        }
+    }
+
+    /**
+     * @brief Reorders \param container so that new slot i holds the element of old slot order[i], 
+     * elements whose slot is not in \param order are destroyed
+     * 
+     * Runs in place in O(container size), \param order is used as scratch and left in an unspecified state.
+     * 
+     * @tparam Container 
+     * @param container 
+     * @param order distinct old slots
+     */
+    template<class Container>
+    void reorder_in_place(Container& container, std::vector<std::uint32_t>& order){
+        const auto keep_count_ = order.size();
+        const auto pool_size_ = container.size();
+        assert(keep_count_ <= pool_size_);
+
+        // complete order to a permutation, dropped slots go to the tail
+        if(keep_count_ < pool_size_){
+            std::vector<bool> kept_(pool_size_, false);
+            for(auto slot_ : order){
+                kept_[slot_] = true;
+            }
+            for(std::uint32_t slot_ = 0; slot_ < pool_size_; ++slot_){
+                if(!kept_[slot_]){
+                    order.push_back(slot_);
+                }
+            }
+        }
+
+        // follow every cycle of the permutation once, visited slots are marked with done_
+        constexpr auto done_ = std::numeric_limits<std::uint32_t>::max();
+        for(std::uint32_t i = 0; i < pool_size_; ++i){
+            if(order[i] == done_ || order[i] == i){
+                continue;
+            }
+
+            typename Container::value_type tmp_ = std::move(container[i]);
+            auto dst_ = i;
+            while(true){
+                const auto src_ = order[dst_];
+                order[dst_] = done_;
+                if(src_ == i){
+                    container[dst_] = std::move(tmp_);
+                    break;
+                }
+                container[dst_] = std::move(container[src_]);
+                dst_ = src_;
+            }
+        }
+
+        while(container.size() > keep_count_){
+            container.pop_back();
+        }
+    }
+
+}
+
+/**
+ * @brief Pool of an empty component, holds no instances, every entity shares instance_
+ * 
+ * @tparam T Component Type
+ */
+template<typename T>
+struct empty_pool{
+    static inline T instance_{};
+
+    void clear() noexcept{}
+};
+
+/**
+ * @brief Pool of a double buffered component
+ * 
+ * Holds the current tick (written by systems) and the previous tick (read by systems) buffers. Writers go 
+ * through operator[], which marks the slot dirty, readers go through previous(), they touch different memory 
+ * and can run concurrently. swap() flips the buffers in O(1) and copies the dirty slots into the new current 
+ * buffer so that it starts the tick up to date.
+ * 
+ * @tparam Container component container, std::vector<T> or fixed_vector<T, N>
+ * @tparam FlagContainer dirty flag container, std::vector<std::uint8_t> or fixed_vector<std::uint8_t, N>
+ */
+template<class Container, class FlagContainer>
+class double_buffered_pool{
+public:
+    using value_type = typename Container::value_type;
+
+    [[nodiscard]] std::size_t size() const noexcept{
+        return buffers_[0].size();
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept{
+        return buffers_[0].capacity();
+    }
+
+    [[nodiscard]] bool full() const noexcept{
+        return buffers_[0].full();
+    }
+
+    /**
+     * @brief Bytes of both buffers and the dirty flags
+     * 
+     */
+    [[nodiscard]] std::size_t bytes() const noexcept{
+        return 2 * capacity() * sizeof(value_type) + dirty_.capacity() * sizeof(typename FlagContainer::value_type);
+    }
+
+    void push_back(const value_type& value){
+        buffers_[0].push_back(value);
+        buffers_[1].push_back(value);
+        dirty_.push_back(0);
+    }
+
+    void reserve(std::size_t count){
+        buffers_[0].reserve(count);
+        buffers_[1].reserve(count);
+        dirty_.reserve(count);
+    }
+
+    /**
+     * @brief Appends \param count copies of \param value
+     * 
+     * @param count 
+     * @param value 
+     */
+    void append(std::size_t count, const value_type& value){
+        const auto size_ = size();
+        buffers_[0].resize(size_ + count, value);
+        buffers_[1].resize(size_ + count, value);
+        dirty_.resize(size_ + count, 0);
+    }
+
+    void clear() noexcept{
+        buffers_[0].clear();
+        buffers_[1].clear();
+        dirty_.clear();
+    }
+
+    /**
+     * @brief Write access to the current tick value, marks the slot dirty
+     * 
+     * @param index 
+     */
+    [[nodiscard]] value_type& operator[](std::size_t index) noexcept{
+        dirty_[index] = 1;
+        return buffers_[current_][index];
+    }
+
+    /**
+     * @brief Read access to the current tick value, does not mark the slot dirty
+     * 
+     * @param index 
+     */
+    [[nodiscard]] const value_type& current(std::size_t index) const noexcept{
+        return buffers_[current_][index];
+    }
+
+    /**
+     * @brief Read access to the previous tick value
+     * 
+     * @param index 
+     */
+    [[nodiscard]] const value_type& previous(std::size_t index) const noexcept{
+        return buffers_[current_ ^ 1u][index];
+    }
+
+    /**
+     * @brief Returns the number of slots written during the tick, the ones swap() copies
+     * 
+     */
+    [[nodiscard]] std::size_t dirty_count() const noexcept{
+        std::size_t count_{0};
+        for(std::size_t i = 0; i < dirty_.size(); ++i){
+            count_ += dirty_[i] ? 1u : 0u;
+        }
+        return count_;
+    }
+
+    /**
+     * @brief Publishes the current buffer as the previous tick
+     * 
+     */
+    void swap(){
+        current_ ^= 1u;
+
+        auto& current_buffer_ = buffers_[current_];
+        const auto& previous_buffer_ = buffers_[current_ ^ 1u];
+        for(std::size_t i = 0; i < dirty_.size(); ++i){
+            if(dirty_[i]){
+                current_buffer_[i] = previous_buffer_[i];
+                dirty_[i] = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Applies detail::reorder_in_place to both buffers and the dirty flags
+     * 
+     * @param order 
+     */
+    void reorder(std::vector<std::uint32_t>& order){
+        std::vector<std::uint32_t> order_copy_{order};
+        detail::reorder_in_place(buffers_[0], order_copy_);
+        order_copy_ = order;
+        detail::reorder_in_place(buffers_[1], order_copy_);
+        detail::reorder_in_place(dirty_, order);
+    }
+
+private:
+    std::array<Container, 2> buffers_{};
+    FlagContainer dirty_{};
+    std::uint32_t current_{0};
+};
+
 /**
  * @brief 
  * 
@@ -16,8 +252,18 @@ class component_storage{
     using component_list = typename ECT::component_list;
     using entity_t = entity<ECT>;
 
+    template<typename T>
+    using container_t = typename ECT::template component_container_t<T>;
+
+    template<typename T>
+    using pool_t = std::conditional_t<ECT::template is_empty_component<T>(), 
+                                      empty_pool<T>, 
+                                      std::conditional_t<ECT::template is_double_buffered<T>(), 
+                                                         double_buffered_pool<container_t<T>, container_t<std::uint8_t>>, 
+                                                         container_t<T>>>;
+
     template<typename... Args>
-    static std::tuple<std::vector<Args>...> to_tuple(yaecs::mpl::type_list<Args...>);
+    static std::tuple<pool_t<Args>...> to_tuple(yaecs::mpl::type_list<Args...>);
 
     template <typename seq>
     struct type_list_to_tuple {
@@ -32,23 +278,263 @@ class component_storage{
 
 public:
 
+    /// returned by add_component when a fixed capacity pool is full
+    constexpr static std::uint32_t invalid_data_index_{std::numeric_limits<std::uint32_t>::max()};
+
+    /**
+     * @brief Returns true if \param count \tparam T instances can be added without exceeding a fixed capacity
+     * 
+     * @tparam T Component Type
+     * @param count 
+     */
+    template<typename T>
+    [[nodiscard]] bool can_add_component([[maybe_unused]] std::size_t count = 1) const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::fixed_capacity_ && !ECT::template is_empty_component<T>()){
+            const auto& pool_ = std::get<pool_t<T>>(components_);
+            return pool_.capacity() - pool_.size() >= count;
+        }
+        else{
+            return true;
+        }
+    }
+
+    /**
+     * @brief Appends \param c to the \tparam T pool
+     * 
+     * @tparam T Component Type
+     * @param c 
+     * @return std::uint32_t data index of \param c, invalid_data_index_ if a fixed capacity pool is full
+     */
     template<typename T>
     std::uint32_t add_component(T c){
-        static_assert(ECT::template is_component<T>(), "T is not a component");   
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else{
+            pool_t<T>& component_vector_ = std::get<pool_t<T>>(components_);
+
+            if constexpr(ECT::fixed_capacity_){
+                if(component_vector_.full()) [[unlikely]] {
+                    return invalid_data_index_;
+                }
+            }
 
-        std::vector<T>& component_vector_ = std::get<std::vector<T>>(components_);
+            auto vec_size_ = component_vector_.size();
+            component_vector_.push_back(c);
 
-        auto vec_size_ = component_vector_.size();
-        component_vector_.push_back(c);
+            return static_cast<std::uint32_t>(vec_size_);
+        }
+    }
+
+    /**
+     * @brief Makes room for \param count more \tparam T instances
+     * 
+     * @tparam T Component Type
+     * @param count 
+     */
+    template<typename T>
+    void reserve([[maybe_unused]] std::size_t count){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
 
-        return static_cast<std::uint32_t>(vec_size_);
+        if constexpr(!ECT::template is_empty_component<T>()){
+            pool_t<T>& pool_ = std::get<pool_t<T>>(components_);
+            detail::reserve_geometric(pool_, pool_.size() + count);
+        }
     }
 
+    /**
+     * @brief Appends \param count copies of \param c to the \tparam T pool with a single reservation
+     * 
+     * @tparam T Component Type
+     * @param c 
+     * @param count 
+     * @return std::uint32_t data index of the first copy, the copies are contiguous, invalid_data_index_ if a 
+     * fixed capacity pool cannot hold them
+     */
     template<typename T>
-    [[nodiscard]] T& get_component(std::uint32_t data_index) noexcept{
-        static_assert(ECT::template is_component<T>(), "T is not a component");   
+    std::uint32_t add_components([[maybe_unused]] const T& c, [[maybe_unused]] std::size_t count){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else{
+            if(!can_add_component<T>(count)) [[unlikely]] {
+                return invalid_data_index_;
+            }
+
+            pool_t<T>& pool_ = std::get<pool_t<T>>(components_);
+            const auto first_ = pool_.size();
+            if constexpr(ECT::template is_double_buffered<T>()){
+                pool_.append(count, c);
+            }
+            else{
+                pool_.resize(first_ + count, c);
+            }
+
+            return static_cast<std::uint32_t>(first_);
+        }
+    }
+
+    template<typename T>
+    [[nodiscard]] T& get_component([[maybe_unused]] std::uint32_t data_index) noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return empty_pool<T>::instance_;
+        }
+        else{
+            return std::get<pool_t<T>>(components_)[data_index];
+        }
+    }
+
+    /**
+     * @brief Read only access, does not mark double buffered slots dirty
+     * 
+     * @tparam T Component Type
+     * @param data_index 
+     */
+    template<typename T>
+    [[nodiscard]] const T& get_component([[maybe_unused]] std::uint32_t data_index) const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return empty_pool<T>::instance_;
+        }
+        else if constexpr(ECT::template is_double_buffered<T>()){
+            return std::get<pool_t<T>>(components_).current(data_index);
+        }
+        else{
+            return std::get<pool_t<T>>(components_)[data_index];
+        }
+    }
+
+    /**
+     * @brief Returns the instance count of the \tparam T pool, including dead instances
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    [[nodiscard]] std::size_t size() const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else{
+            return std::get<pool_t<T>>(components_).size();
+        }
+    }
+
+    /**
+     * @brief Returns the instance count the \tparam T pool can hold without growing
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    [[nodiscard]] std::size_t capacity() const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else{
+            return std::get<pool_t<T>>(components_).capacity();
+        }
+    }
+
+    /**
+     * @brief Returns the bytes held by the \tparam T pool
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    [[nodiscard]] std::size_t bytes() const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else if constexpr(ECT::template is_double_buffered<T>()){
+            return std::get<pool_t<T>>(components_).bytes();
+        }
+        else{
+            return capacity<T>() * sizeof(T);
+        }
+    }
+
+    /**
+     * @brief Reorders the \tparam T pool so that new slot i holds the instance of old slot order[i], 
+     * instances whose slot is not in \param order are destroyed
+     * 
+     * Runs in place in O(pool size), \param order is used as scratch and left in an unspecified state.
+     * 
+     * @tparam T Component Type
+     * @param order distinct old slots
+     */
+    template<typename T>
+    void reorder(std::vector<std::uint32_t>& order){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+        static_assert(!ECT::template is_empty_component<T>(), "empty components have no pool");
+
+        pool_t<T>& pool_ = std::get<pool_t<T>>(components_);
+
+        if constexpr(ECT::template is_double_buffered<T>()){
+            pool_.reorder(order);
+        }
+        else{
+            detail::reorder_in_place(pool_, order);
+        }
+    }
+
+    /**
+     * @brief Publishes the current buffer of every double buffered pool as the previous tick, see double_buffered_pool::swap
+     * 
+     */
+    void swap_buffers(){
+        yaecs::mpl::for_each_type<typename ECT::buffered_component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            if constexpr(ECT::template is_double_buffered<T>()){
+                std::get<pool_t<T>>(components_).swap();
+            }
+        });
+    }
+
+    /**
+     * @brief Returns the previous tick value of a double buffered \tparam T
+     * 
+     * @tparam T Component Type
+     * @param data_index 
+     */
+    template<typename T>
+    [[nodiscard]] const T& get_previous_component(std::uint32_t data_index) const noexcept{
+        static_assert(ECT::template is_double_buffered<T>(), "T is not double buffered");
+
+        return std::get<pool_t<T>>(components_).previous(data_index);
+    }
+
+    /**
+     * @brief Returns the number of double buffered \tparam T slots written during the tick
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    [[nodiscard]] std::size_t dirty_count() const noexcept{
+        static_assert(ECT::template is_double_buffered<T>(), "T is not double buffered");
+
+        return std::get<pool_t<T>>(components_).dirty_count();
+    }
 
-        return std::get<std::vector<T>>(components_)[data_index];
+    /**
+     * @brief Removes every component instance from all pools
+     * 
+     */
+    void clear() noexcept{
+        std::apply([](auto&... pools){ (pools.clear(), ...); }, components_);
     }
 
 private:
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "../mpl/mpl.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <latch>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace yaecs{
+
+template<typename ECT>
+class ec_engine;
+
+/**
+ * @brief Creates entities and adds components from several threads without locking, see ec_engine::begin_concurrent_load
+ *
+ * The engine reserves a block of entity ids up front, create_entity hands them out with an atomic counter.
+ * Every thread works with its own stage: components are staged in the stage and published into the pools by
+ * commit(), which fills every pool from its own thread once enough components are staged. A stage may only add components to the entities it
+ * created. The engine must not be used otherwise until commit() returns, loaded entities are visible to queries
+ * after it.
+ *
+ * @tparam ECT entity component traits
+ */
+template<typename ECT>
+class concurrent_loader{
+    using engine_t = ec_engine<ECT>;
+    using component_list = typename ECT::component_list;
+
+    template<typename... Ts>
+    static std::tuple<std::vector<std::pair<std::uint32_t, Ts>>...> to_tuple(yaecs::mpl::type_list<Ts...>);
+
+    using staged_t = decltype(to_tuple(std::declval<component_list>()));
+
+public:
+    /// below this many staged components commit() publishes on the calling thread, thread startup would dominate
+    constexpr static std::size_t parallel_publish_threshold_{4096};
+
+    /**
+     * @brief Per thread staging area
+     */
+    class stage{
+    public:
+        explicit stage(concurrent_loader& loader)
+            : loader_{&loader}
+        {
+        }
+
+        /**
+         * @brief Creates an entity, thread safe
+         *
+         * @return std::uint32_t Entity id, invalid_entity_id_ if the reserved block is exhausted
+         */
+        std::uint32_t create_entity() noexcept{
+            return loader_->create_entity();
+        }
+
+        /**
+         * @brief Stages the \param c component of an entity created by this stage
+         *
+         * @tparam T Component Type
+         * @param entity_id
+         * @param c
+         */
+        template<typename T>
+        void add_component(std::uint32_t entity_id, T c){
+            static_assert(ECT::template is_component<T>(), "T is not a component");
+            assert(loader_->owns(entity_id));
+
+            loader_->engine_.entities_[entity_id].template set_signature<T>(true);
+            if constexpr(!ECT::template is_empty_component<T>()){
+                std::get<std::vector<std::pair<std::uint32_t, T>>>(staged_).emplace_back(entity_id, std::move(c));
+            }
+        }
+
+    private:
+        friend class concurrent_loader;
+
+        concurrent_loader* loader_;
+        staged_t staged_{};
+    };
+
+    concurrent_loader(engine_t& engine, std::uint32_t first_id, std::uint32_t capacity, std::size_t stage_count)
+        : engine_{engine}
+        , first_id_{first_id}
+        , capacity_{capacity}
+    {
+        stages_.reserve(stage_count);
+        for(std::size_t i = 0; i < stage_count; ++i){
+            stages_.emplace_back(*this);
+        }
+    }
+
+    concurrent_loader(const concurrent_loader&) = delete;
+    concurrent_loader& operator=(const concurrent_loader&) = delete;
+
+    /**
+     * @brief Creates an entity, thread safe
+     *
+     * @return std::uint32_t Entity id, invalid_entity_id_ if the reserved block is exhausted
+     */
+    std::uint32_t create_entity() noexcept{
+        const auto index_ = next_.fetch_add(1, std::memory_order_relaxed);
+        return index_ < capacity_ ? first_id_ + index_ : engine_t::invalid_entity_id_;
+    }
+
+    /**
+     * @brief Returns the stage of one thread, \param index < stage_count()
+     *
+     * @param index
+     */
+    stage& get_stage(std::size_t index) noexcept{
+        assert(index < stages_.size());
+        return stages_[index];
+    }
+
+    [[nodiscard]] std::size_t stage_count() const noexcept{
+        return stages_.size();
+    }
+
+    /**
+     * @brief Publishes the staged components into the pools and releases the unused part of the reserved block
+     *
+     * Small loads are published on the calling thread, from parallel_publish_threshold_ staged components on
+     * every pool is published by its own thread. Must be called once, after every thread is done with its stage.
+     *
+     * @return false if a fixed capacity pool could not hold its staged components, those are dropped
+     */
+    bool commit(){
+        auto plan_ = plan();
+
+        if(plan_.staged < parallel_publish_threshold_){
+            for(auto& [pool_index_, task_] : plan_.tasks){
+                task_();
+            }
+        }
+        else{
+            std::vector<std::thread> workers_{};
+            workers_.reserve(plan_.tasks.size());
+            for(auto& [pool_index_, task_] : plan_.tasks){
+                workers_.emplace_back(std::move(task_));
+            }
+            for(std::thread& worker_ : workers_){
+                worker_.join();
+            }
+        }
+
+        release_unused();
+        return plan_.fits;
+    }
+
+    /**
+     * @brief Publishes the staged components on caller owned workers and releases the unused part of the
+     * reserved block
+     *
+     * \param e is invoked with (component index, task) for every pool with staged components and must run task 
+     * once, on any thread. Returns when every task is done. Must be called once, after every thread is done with 
+     * its stage.
+     *
+     * @tparam executor
+     * @param e
+     * @return false if a fixed capacity pool could not hold its staged components, those are dropped
+     */
+    template<class executor>
+    bool commit(executor&& e){
+        auto plan_ = plan();
+
+        std::latch done_{static_cast<std::ptrdiff_t>(plan_.tasks.size())};
+        for(auto& [pool_index_, task_] : plan_.tasks){
+            e(pool_index_, [&done_, &task = task_](){
+                task();
+                done_.count_down();
+            });
+        }
+        done_.wait();
+
+        release_unused();
+        return plan_.fits;
+    }
+
+private:
+    struct publish_plan{
+        std::vector<std::pair<std::size_t, std::function<void()>>> tasks{};
+        std::size_t staged{0};
+        bool fits{true};
+    };
+
+    /**
+     * @brief Builds one publish task per pool with staged components, the components of pools that can not
+     * hold them are dropped
+     */
+    publish_plan plan(){
+        publish_plan plan_{};
+
+        yaecs::mpl::for_each_type<component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            if constexpr(!ECT::template is_empty_component<T>()){
+                std::size_t count_{0};
+                for(const stage& stage_ : stages_){
+                    count_ += staged<T>(stage_).size();
+                }
+
+                if(count_ == 0){
+                    return;
+                }
+
+                if(!engine_.components_.template can_add_component<T>(count_)) [[unlikely]] {
+                    drop<T>();
+                    plan_.fits = false;
+                    return;
+                }
+
+                plan_.staged += count_;
+                plan_.tasks.emplace_back(static_cast<std::size_t>(ECT::template component_index<T>()),
+                                         [this, count_](){ publish<T>(count_); });
+            }
+        });
+
+        return plan_;
+    }
+
+    /**
+     * @brief The block is at the end of the entity table, its unused ids are released
+     */
+    void release_unused(){
+        const auto used_ = std::min(next_.load(std::memory_order_acquire), capacity_);
+        while(engine_.entities_.size() > first_id_ + used_){
+            engine_.entities_.pop_back();
+        }
+        engine_.entity_count_ = first_id_ + used_;
+    }
+
+    template<typename T>
+    static const std::vector<std::pair<std::uint32_t, T>>& staged(const stage& s) noexcept{
+        return std::get<std::vector<std::pair<std::uint32_t, T>>>(s.staged_);
+    }
+
+    template<typename T>
+    static std::vector<std::pair<std::uint32_t, T>>& staged(stage& s) noexcept{
+        return std::get<std::vector<std::pair<std::uint32_t, T>>>(s.staged_);
+    }
+
+    [[nodiscard]] bool owns(std::uint32_t entity_id) const noexcept{
+        return entity_id >= first_id_ && entity_id - first_id_ < capacity_;
+    }
+
+    /**
+     * @brief Moves the staged \tparam T components into their pool, only touches the \tparam T pool and
+     * data indices so pools can be published concurrently
+     */
+    template<typename T>
+    void publish(std::size_t count){
+        engine_.components_.template reserve<T>(count);
+
+        for(stage& stage_ : stages_){
+            auto& staged_ = staged<T>(stage_);
+            for(auto& [entity_id_, c_] : staged_){
+                const auto data_index_ = engine_.components_.template add_component<T>(std::move(c_));
+                engine_.entities_[entity_id_].template set_data_index<T>(data_index_);
+            }
+            staged_.clear();
+        }
+    }
+
+    template<typename T>
+    void drop(){
+        for(stage& stage_ : stages_){
+            auto& staged_ = staged<T>(stage_);
+            for(const auto& item_ : staged_){
+                engine_.entities_[item_.first].template set_signature<T>(false);
+            }
+            staged_.clear();
+        }
+    }
+
+private:
+    engine_t& engine_;
+    const std::uint32_t first_id_;
+    const std::uint32_t capacity_;
+    std::atomic<std::uint32_t> next_{0};
+    std::vector<stage> stages_{};
+};
+
+} // namespace yaecs
@@ -3,10 +3,20 @@
 #include "ec_traits.hpp"
 #include "entity.hpp"
 #include "component_storage.hpp"
+#include "hierarchy.hpp"
+#include "prefab.hpp"
+#include "concurrent_loader.hpp"
+#include "memory_report.hpp"
+#include "query.hpp"
 
 #include "../mpl/mpl.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <limits>
+#include <utility>
+#include <vector>
 
 namespace yaecs{
 
@@ -23,15 +33,30 @@ class ec_engine{
 
     using entity_t              = entity<ec_traits_type>;
     using component_storage_t   = component_storage<ec_traits_type>;
+    using hierarchy_t           = hierarchy<ec_traits_type>;
+
+    friend class concurrent_loader<ec_traits_type>;
 
 public:
+    using prefab_t              = prefab<ec_traits_type>;
+    using concurrent_loader_t   = concurrent_loader<ec_traits_type>;
+
+
+    /// returned by create_entity when a fixed capacity entity table is full
+    constexpr static std::uint32_t invalid_entity_id_{std::numeric_limits<std::uint32_t>::max()};
 
     /**
      * @brief Creates an entity
      * 
-     * @return std::uint32_t Entity id
+     * @return std::uint32_t Entity id, invalid_entity_id_ if a fixed capacity entity table is full
      */
     std::uint32_t create_entity() noexcept{
+        if constexpr(ECT::fixed_capacity_){
+            if(entities_.full()) [[unlikely]] {
+                return invalid_entity_id_;
+            }
+        }
+
         std::uint32_t e_id_{0};
 
         entities_.push_back(std::move(entity_t{entity_count_}));
@@ -55,6 +80,12 @@ public:
         }
     }
 
+    inline void clear_tag(std::uint32_t entity_id) noexcept{
+        if(entity_id < entity_count_) [[likely]] {
+            entities_[entity_id].clear_tag();
+        }
+    }
+
     /**
      * @brief Returns the entity count
      * 
@@ -70,16 +101,22 @@ public:
      * @tparam T Component Type
      * @param entity_id 
      * @param c 
+     * @return false if a fixed capacity pool is full, the entity is left unchanged
      */
     template<typename T> 
-    void add_component(std::uint32_t entity_id, T c) {
+    bool add_component(std::uint32_t entity_id, T c) {
         static_assert(ECT::template is_component<T>(), "T is not a component");
         assert(!(entity_id > entity_count_));
 
+        auto data_index = components_.template add_component<T>(std::move(c));
+        if(data_index == component_storage_t::invalid_data_index_) [[unlikely]] {
+            return false;
+        }
+
         entity_t& entity_ = entities_[entity_id];
-        entity_.set_signature<T>(true);
-        auto data_index = components_.add_component<T>(std::move(c));
-        entity_.set_data_index<T>(data_index);
+        entity_.template set_signature<T>(true);
+        entity_.template set_data_index<T>(data_index);
+        return true;
     }
 
     /**
@@ -87,17 +124,191 @@ public:
      * 
      * @tparam T Component Type
      * @param entity_id 
+     * @return false if a fixed capacity pool is full, the entity is left unchanged
      */
     template<typename T>
-    void add_component(std::uint32_t entity_id){
+    bool add_component(std::uint32_t entity_id){
         static_assert(ECT::template is_component<T>(), "T is not a component");
         static_assert(std::is_default_constructible_v<T>, "T is not default constructible");
-        assert(!(entity_id > entity_count_));
 
-        entity_t& entity_ = entities_[entity_id];
-        entity_.set_signature<T>(true);
-        auto data_index = components_.add_component<T>(T{});
-        entity_.set_data_index<T>(data_index);
+        return add_component<T>(entity_id, T{});
+    }
+
+    /**
+     * @brief Returns true if \param count \tparam T components can be added without exceeding a fixed capacity
+     * 
+     * @tparam T Component Type
+     * @param count 
+     */
+    template<typename T>
+    [[nodiscard]] bool can_add_component(std::size_t count = 1) const noexcept{
+        return components_.template can_add_component<T>(count);
+    }
+
+    /**
+     * @brief Returns true if \param count entities can be created without exceeding a fixed capacity
+     * 
+     * @param count 
+     */
+    [[nodiscard]] bool can_create_entities(std::size_t count) const noexcept{
+        if constexpr(ECT::fixed_capacity_){
+            return entities_.capacity() - entities_.size() >= count;
+        }
+        else{
+            return true;
+        }
+    }
+
+    /**
+     * @brief Reserves a block of \param entity_capacity entities to be created from several threads, see concurrent_loader
+     * 
+     * The block is clamped to the free capacity of a fixed capacity engine.
+     * 
+     * @param entity_capacity 
+     * @param stage_count one stage per loading thread
+     * @return concurrent_loader_t 
+     */
+    concurrent_loader_t begin_concurrent_load(std::uint32_t entity_capacity, std::size_t stage_count){
+        if constexpr(ECT::fixed_capacity_){
+            entity_capacity = std::min(entity_capacity, static_cast<std::uint32_t>(entities_.capacity() - entities_.size()));
+        }
+
+        const auto first_id_ = entity_count_;
+        detail::reserve_geometric(entities_, entities_.size() + entity_capacity);
+        for(std::uint32_t i = 0; i < entity_capacity; ++i){
+            entities_.push_back(entity_t{first_id_ + i});
+        }
+        entity_count_ += entity_capacity;
+
+        return concurrent_loader_t{*this, first_id_, entity_capacity, stage_count};
+    }
+
+    /**
+     * @brief Captures the components and the tag of the entity into a prefab
+     * 
+     * @param entity_id 
+     * @return prefab_t 
+     */
+    [[nodiscard]] prefab_t make_prefab(std::uint32_t entity_id) const{
+        assert(entity_id < entity_count_);
+
+        prefab_t prefab_{};
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            if(has_component<T>(entity_id)){
+                prefab_.template set<T>(std::as_const(components_).template get_component<T>(entities_[entity_id].template get_data_index<T>()));
+            }
+        });
+
+        const int tag_ = entities_[entity_id].tag();
+        yaecs::mpl::for_each_type<typename ECT::tag_list>([&](auto type){
+            using Tag = typename decltype(type)::type;
+            if(ECT::template tag_index<Tag>() == tag_){
+                prefab_.template set_tag<Tag>();
+            }
+        });
+
+        return prefab_;
+    }
+
+    /**
+     * @brief Creates \param count copies of \param prefab
+     * 
+     * Every pool is grown once and filled with copies of the prefab value, entities are copies of the prefab 
+     * entity with their data indices offset.
+     * 
+     * @param prefab 
+     * @param count 
+     * @return std::uint32_t Id of the first entity, the ids are contiguous, invalid_entity_id_ if the copies do not 
+     * fit into a fixed capacity engine, nothing is created then
+     */
+    std::uint32_t instantiate(const prefab_t& prefab, std::uint32_t count){
+        const entity_t& prototype_ = prefab.prototype();
+
+        if constexpr(ECT::fixed_capacity_){
+            bool fits_{can_create_entities(count)};
+            yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+                using T = typename decltype(type)::type;
+                fits_ = fits_ && (!prototype_.template get_signature<T>() || components_.template can_add_component<T>(count));
+            });
+
+            if(!fits_) [[unlikely]] {
+                return invalid_entity_id_;
+            }
+        }
+
+        // prototype with the data indices of the first copy
+        entity_t first_{entity_count_, prototype_};
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            if(prototype_.template get_signature<T>()){
+                first_.template set_data_index<T>(components_.template add_components<T>(prefab.template get<T>(), count));
+            }
+        });
+
+        const auto first_id_ = entity_count_;
+        detail::reserve_geometric(entities_, entities_.size() + count);
+        for(std::uint32_t i = 0; i < count; ++i){
+            entity_t entity_{first_id_ + i, first_};
+            entity_.offset_data_indices(i);
+            entities_.push_back(entity_);
+        }
+        entity_count_ += count;
+
+        return first_id_;
+    }
+
+    /**
+     * @brief Returns true if the entity has a \tparam T component
+     * 
+     * @tparam T Component Type
+     * @param entity_id 
+     */
+    template<typename T>
+    [[nodiscard]] bool has_component(std::uint32_t entity_id) const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+        assert(entity_id < entity_count_);
+
+        return entities_[entity_id].template get_signature<T>();
+    }
+
+    /**
+     * @brief Returns the \tparam T component of the entity, entity must have it
+     * 
+     * @tparam T Component Type
+     * @param entity_id 
+     */
+    template<typename T>
+    [[nodiscard]] T& get_component(std::uint32_t entity_id) noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+        assert(has_component<T>(entity_id));
+
+        return components_.template get_component<T>(entities_[entity_id].template get_data_index<T>());
+    }
+
+    /**
+     * @brief Detaches the \tparam T component from the entity, its pool slot is left dead
+     * 
+     * @tparam T Component Type
+     * @param entity_id 
+     */
+    template<typename T>
+    void remove_component(std::uint32_t entity_id) noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+        assert(entity_id < entity_count_);
+
+        entities_[entity_id].template set_signature<T>(false);
+    }
+
+    /**
+     * @brief Removes all entities and components
+     * 
+     */
+    void clear() noexcept{
+        entities_.clear();
+        components_.clear();
+        hierarchy_.clear();
+        entity_count_ = 0;
     }
 
     /**
@@ -113,12 +324,12 @@ public:
         for (const entity_t& entity_ : entities_){
             if(entity_.get_signature<T>()){
                 auto data_index_ = entity_.get_data_index<T>();
-                if constexpr(std::is_invocable_v<callable, T&>){
+                if constexpr(std::is_invocable_v<callable, T&> && !yaecs::mpl::reads_only_v<callable>){
                     auto& data_ = components_.get_component<T>(data_index_);
                     c(data_);
                 }
                 else if constexpr(std::is_invocable_v<callable, const T&>){
-                    const auto& data_ = components_.get_component<T>(data_index_);
+                    const auto& data_ = std::as_const(components_).template get_component<T>(data_index_);
                     c(data_);
                 }
             }
@@ -136,12 +347,17 @@ public:
     template<typename Tag, class Callable, typename... Components>
     void each_matching_tag(Callable c){
         static_assert(ECT::template is_tag<Tag>(), "tparam Tag is not a tag");
-        constexpr auto tag_index = static_cast<int>(ECT::template tag_index<Tag>());
-        auto sig_ = build_signature<Components...>();
+        if constexpr(ECT::fits_word_mask()){
+            for_query<query<with<Components...>, tagged<Tag>>>(c);
+        }
+        else{
+            constexpr auto tag_index = static_cast<int>(ECT::template tag_index<Tag>());
+            auto sig_ = build_signature<Components...>();
 
-        for (const entity_t& entity_ : entities_){
-            if(entity_.tag() == tag_index && entity_.check(sig_)){
-                c( components_.get_component<Components>(entity_.get_data_index<Components>())... );
+            for (const entity_t& entity_ : entities_){
+                if(entity_.tag() == tag_index && entity_.check(sig_)){
+                    c( component_for<Components, Callable>(entity_.template get_data_index<Components>())... );
+                }
             }
         }
     }
@@ -155,14 +371,349 @@ public:
      */
     template<typename... Ts, class callable>
     void for_matching_entities(callable c){
-        auto sig_ = build_signature<Ts...>();
-        for (entity_t& entity_ : entities_){
-            if(entity_.check(sig_)){
-                c( components_.get_component<Ts>(entity_.get_data_index<Ts>())... );
+        if constexpr(ECT::fits_word_mask()){
+            for_query<query<with<Ts...>>>(c);
+        }
+        else{
+            auto sig_ = build_signature<Ts...>();
+            for (entity_t& entity_ : entities_){
+                if(entity_.check(sig_)){
+                    c( component_for<Ts, callable>(entity_.template get_data_index<Ts>())... );
+                }
             }
         }
     } 
 
+    /**
+     * @brief Invokes \param c with the with<...> components of every entity matching \tparam Q
+     * 
+     * Entities are filtered on their signature and tag only, component memory is touched for matches alone.
+     * 
+     * @tparam Q query<with<...>, without<...>, any_of<...>, tagged<...>>
+     * @tparam callable 
+     * @param c 
+     */
+    template<typename Q, class callable>
+    void for_query(callable c){
+        using query_traits_t = query_traits<ECT, Q>;
+
+        for_query_impl<query_traits_t>(c, typename query_traits_t::component_list{});
+    }
+
+    /**
+     * @brief Returns the previous tick value of the double buffered \tparam T component of the entity
+     * 
+     * @tparam T Component Type
+     * @param entity_id 
+     */
+    template<typename T>
+    [[nodiscard]] const T& get_previous_component(std::uint32_t entity_id) const noexcept{
+        static_assert(ECT::template is_double_buffered<T>(), "T is not double buffered");
+        assert(has_component<T>(entity_id));
+
+        return components_.template get_previous_component<T>(entities_[entity_id].template get_data_index<T>());
+    }
+
+    /**
+     * @brief Invokes \param c with the previous tick values of the double buffered \tparam Ts of every matching entity
+     * 
+     * Only reads the previous tick buffers, it can run concurrently with systems writing the current tick of Ts.
+     * 
+     * @tparam Ts The double buffered components
+     * @tparam callable 
+     * @param c 
+     */
+    template<typename... Ts, class callable>
+    void for_matching_entities_previous(callable c) const{
+        static_assert((ECT::template is_double_buffered<Ts>() && ...), "Ts are not double buffered");
+
+        const auto sig_ = signature_of<Ts...>();
+        for (const entity_t& entity_ : entities_){
+            if(entity_.check(sig_)){
+                c( components_.template get_previous_component<Ts>(entity_.template get_data_index<Ts>())... );
+            }
+        }
+    }
+
+    /**
+     * @brief Ends the tick of the double buffered components, the values written during the tick become the previous tick
+     * 
+     */
+    void swap_buffers(){
+        components_.swap_buffers();
+    }
+
+    /**
+     * @brief Returns the number of \tparam T slots written during the tick, the ones swap_buffers copies
+     * 
+     * Only writers mark slots, callables taking the components by const reference or by value do not.
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    [[nodiscard]] std::size_t dirty_component_count() const noexcept{
+        return components_.template dirty_count<T>();
+    }
+
+    /**
+     * @brief Reorders the \tparam T pool to follow entity iteration order and drops its dead instances
+     * 
+     * @tparam T Component Type
+     */
+    template<typename T>
+    void compact_pool(){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        pack_pool<T>([&](auto&& visit){
+            for (entity_t& entity_ : entities_){
+                visit(entity_);
+            }
+        });
+    }
+
+    /**
+     * @brief Compacts every component pool, see compact_pool
+     * 
+     */
+    void compact(){
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            compact_pool<typename decltype(type)::type>();
+        });
+        next_compact_pool_ = 0;
+    }
+
+    /**
+     * @brief Compacts the next component pool in round robin order, meant to spread compaction over frames
+     * 
+     * @return true if the last pool was compacted, i.e. a full pass is completed
+     */
+    bool compact_step(){
+        std::size_t index_{0};
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            if(index_++ == next_compact_pool_){
+                compact_pool<typename decltype(type)::type>();
+            }
+        });
+
+        next_compact_pool_ = (next_compact_pool_ + 1) % static_cast<std::size_t>(ECT::component_count());
+        return next_compact_pool_ == 0;
+    }
+
+    /**
+     * @brief Reorders the \tparam T pool by \param cmp and drops its dead instances
+     * 
+     * @tparam T Component Type
+     * @tparam Compare 
+     * @param cmp strict weak ordering of (const T&, const T&)
+     */
+    template<typename T, class Compare>
+    void sort_pool(Compare cmp){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+        static_assert(!ECT::template is_empty_component<T>(), "empty components have no pool");
+
+        std::vector<std::uint32_t> owners_{};
+        for (const entity_t& entity_ : entities_){
+            if(entity_.template get_signature<T>()){
+                owners_.push_back(entity_.id());
+            }
+        }
+
+        // read only access, comparing must not mark double buffered slots dirty
+        const component_storage_t& const_components_ = components_;
+        std::stable_sort(owners_.begin(), owners_.end(), [&](std::uint32_t lhs, std::uint32_t rhs){
+            return cmp(const_components_.template get_component<T>(entities_[lhs].template get_data_index<T>()),
+                       const_components_.template get_component<T>(entities_[rhs].template get_data_index<T>()));
+        });
+
+        order_scratch_.clear();
+        for (auto owner_ : owners_){
+            entity_t& entity_ = entities_[owner_];
+            order_scratch_.push_back(entity_.template get_data_index<T>());
+            entity_.template set_data_index<T>(static_cast<std::uint32_t>(order_scratch_.size() - 1));
+        }
+
+        components_.template reorder<T>(order_scratch_);
+    }
+
+    /**
+     * @brief Links \param child to \param parent, a child can have one parent
+     * 
+     * @param child 
+     * @param parent 
+     * @return false if \param parent is \param child or one of its descendants, the link is not made then
+     */
+    bool set_parent(std::uint32_t child, std::uint32_t parent){
+        assert(parent != invalid_entity_id_);
+        return hierarchy_.set_parent(child, parent, entity_count_);
+    }
+
+    /**
+     * @brief Detaches \param child from its parent, does nothing if it has none
+     * 
+     * @param child 
+     */
+    void remove_parent(std::uint32_t child){
+        hierarchy_.set_parent(child, hierarchy_t::no_parent_, entity_count_);
+    }
+
+    /**
+     * @brief Returns the parent of the entity, invalid_entity_id_ if it has none
+     * 
+     * @param entity_id 
+     */
+    [[nodiscard]] std::uint32_t parent(std::uint32_t entity_id) const noexcept{
+        const auto parent_ = hierarchy_.parent(entity_id);
+        return parent_ == hierarchy_t::no_parent_ ? invalid_entity_id_ : parent_;
+    }
+
+    /**
+     * @brief Returns the number of entities that have a parent
+     * 
+     */
+    [[nodiscard]] std::uint32_t parent_link_count() const noexcept{
+        return hierarchy_.link_count();
+    }
+
+    /**
+     * @brief Rebuilds the depth order of the hierarchy if it changed
+     * 
+     * @return std::size_t depth level count, entities without parent are at level 0
+     */
+    std::size_t update_hierarchy(){
+        hierarchy_.update(entity_count_, order_scratch_);
+        return hierarchy_.level_count();
+    }
+
+    /**
+     * @brief Returns the [begin, end) positions of the entities of depth \param level in the hierarchy order, 
+     * see for_each_hierarchical_range
+     * 
+     * @param level 
+     */
+    [[nodiscard]] std::pair<std::uint32_t, std::uint32_t> hierarchy_level(std::size_t level) const noexcept{
+        return {hierarchy_.level_begin(level), hierarchy_.level_end(level)};
+    }
+
+    /**
+     * @brief Reorders every component pool to follow the hierarchy order, for_each_hierarchical then walks 
+     * the pools linearly
+     * 
+     * compact() restores the entity order.
+     */
+    void sort_by_hierarchy(){
+        hierarchy_.update(entity_count_, order_scratch_);
+
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            pack_pool<typename decltype(type)::type>([&](auto&& visit){
+                for (auto entity_id_ : hierarchy_.order()){
+                    visit(entities_[entity_id_]);
+                }
+            });
+        });
+    }
+
+    /**
+     * @brief Invokes \param c with (Ts&... components, const Ts*... parent_components) for every entity 
+     * having \tparam Ts, parents before their children
+     * 
+     * Parent pointers are nullptr if the entity has no parent or its parent does not have all of \tparam Ts.
+     * 
+     * @tparam Ts The components
+     * @tparam callable 
+     * @param c 
+     */
+    template<typename... Ts, class callable>
+    void for_each_hierarchical(callable c){
+        hierarchy_.update(entity_count_, order_scratch_);
+        for_each_hierarchical_range<Ts...>(0, entity_count_, c);
+    }
+
+    /**
+     * @brief for_each_hierarchical over the [begin, end) positions of the hierarchy order, update_hierarchy must be called first
+     * 
+     * Ranges within one depth level (see hierarchy_level) only read the level above, they can be processed in parallel.
+     * 
+     * @tparam Ts The components
+     * @tparam callable 
+     * @param begin 
+     * @param end 
+     * @param c 
+     */
+    template<typename... Ts, class callable>
+    void for_each_hierarchical_range(std::uint32_t begin, std::uint32_t end, callable c){
+        assert(end <= hierarchy_.order().size());
+
+        const auto sig_ = signature_of<Ts...>();
+        const component_storage_t& const_components_ = components_;
+
+        for (auto position_ = begin; position_ < end; ++position_){
+            entity_t& entity_ = entities_[hierarchy_.order()[position_]];
+            if(!entity_.check(sig_)){
+                continue;
+            }
+
+            const auto parent_ = hierarchy_.parent(entity_.id());
+            if(parent_ != hierarchy_t::no_parent_ && entities_[parent_].check(sig_)){
+                const entity_t& parent_entity_ = entities_[parent_];
+                c( component_for<Ts, callable>(entity_.template get_data_index<Ts>())..., 
+                   &const_components_.template get_component<Ts>(parent_entity_.template get_data_index<Ts>())... );
+            }
+            else{
+                c( component_for<Ts, callable>(entity_.template get_data_index<Ts>())..., 
+                   static_cast<const Ts*>(nullptr)... );
+            }
+        }
+    }
+
+    /**
+     * @brief Reports the memory used by the entity table, every component pool, the hierarchy and the scratch buffers
+     * 
+     * @return memory_report 
+     */
+    [[nodiscard]] memory_report memory_usage() const{
+        constexpr auto component_count_ = static_cast<std::size_t>(ECT::component_count());
+
+        std::array<std::size_t, component_count_> live_{};
+        for (const entity_t& entity_ : entities_){
+            const auto& sig_ = entity_.signature();
+            for(std::size_t i = 0; i < component_count_; ++i){
+                live_[i] += sig_[i] ? 1u : 0u;
+            }
+        }
+
+        memory_report report_{};
+
+        report_.entities.count              = entities_.size();
+        report_.entities.capacity           = entities_.capacity();
+        report_.entities.entity_size        = sizeof(entity_t);
+        report_.entities.bytes              = entities_.capacity() * sizeof(entity_t);
+        report_.entities.data_index_bytes   = entities_.capacity() * entity_t::data_index_storage_size();
+
+        report_.components.reserve(component_count_);
+        yaecs::mpl::for_each_type<typename ECT::component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            constexpr auto index_ = ECT::template component_index<T>();
+
+            component_memory_info info_{};
+            info_.component_index   = index_;
+            info_.element_size      = ECT::template is_empty_component<T>() ? 0 : sizeof(T);
+            info_.size              = components_.template size<T>();
+            info_.capacity          = components_.template capacity<T>();
+            info_.bytes             = components_.template bytes<T>();
+            info_.live              = live_[static_cast<std::size_t>(index_)];
+            // empty components have no slots, only signature bits
+            info_.dead              = ECT::template is_empty_component<T>() ? 0 : info_.size - info_.live;
+            info_.entity_fraction   = entities_.empty() ? 0.0 : static_cast<double>(info_.live) / static_cast<double>(entities_.size());
+
+            report_.components.push_back(info_);
+        });
+
+        report_.hierarchy_bytes = hierarchy_.bytes();
+        report_.scratch_bytes   = order_scratch_.capacity() * sizeof(std::uint32_t);
+
+        return report_;
+    }
+
     /**
      * @brief Builds a signature bitset
      * 
@@ -179,6 +730,64 @@ public:
 
 private:
 
+    /**
+     * @brief Reorders the \tparam T pool to follow the order \param for_each_entity visits the entities in
+     * 
+     * @tparam T Component Type
+     * @tparam visitor 
+     * @param for_each_entity invoked with a callable to call with every entity
+     */
+    template<typename T, class visitor>
+    void pack_pool(visitor for_each_entity){
+        if constexpr(!ECT::template is_empty_component<T>()){
+            order_scratch_.clear();
+            for_each_entity([&](entity_t& entity_){
+                if(entity_.template get_signature<T>()){
+                    order_scratch_.push_back(entity_.template get_data_index<T>());
+                    entity_.template set_data_index<T>(static_cast<std::uint32_t>(order_scratch_.size() - 1));
+                }
+            });
+
+            components_.template reorder<T>(order_scratch_);
+        }
+    }
+
+    /**
+     * @brief Component access for \tparam callable, read only callables do not mark double buffered slots dirty
+     * 
+     * @tparam T Component Type
+     * @tparam callable 
+     * @param data_index 
+     */
+    template<typename T, class callable>
+    decltype(auto) component_for(std::uint32_t data_index) noexcept{
+        if constexpr(yaecs::mpl::reads_only_v<callable>){
+            return std::as_const(components_).template get_component<T>(data_index);
+        }
+        else{
+            return components_.template get_component<T>(data_index);
+        }
+    }
+
+    template<typename QT, class callable, typename... Ts>
+    void for_query_impl(callable& c, yaecs::mpl::type_list<Ts...>){
+        for (entity_t& entity_ : entities_){
+            if(QT::matches(entity_.signature(), entity_.tag())){
+                c( component_for<Ts, callable>(entity_.template get_data_index<Ts>())... );
+            }
+        }
+    }
+
+    template<typename... Ts>
+    static component_signature_storage_t signature_of(){
+        if constexpr(ECT::fits_word_mask()){
+            return ECT::template component_mask<Ts...>();
+        }
+        else{
+            return build_signature<Ts...>();
+        }
+    }
+
     template<typename T>
     static void set_signature(component_signature_storage_t& sig) {
         sig.set(ECT::template component_index<T>());
@@ -186,10 +795,14 @@ private:
 
 
 private:
-    std::vector<entity_t> entities_{};
+    typename ECT::template entity_container_t<entity_t> entities_{};
     component_storage_t components_{};
+    hierarchy_t hierarchy_{};
 
     std::uint32_t entity_count_{0};
+
+    std::vector<std::uint32_t> order_scratch_{};
+    std::size_t next_compact_pool_{0};
 };
 
 
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <type_traits>
+#include <vector>
+
+#include "fixed_vector.hpp"
 
 #include "../mpl/mpl.hpp"
 
@@ -17,16 +23,26 @@ using component_list = yaecs::mpl::type_list<Ts...>;
  * 
  * @tparam CL component list
  * @tparam TL tag list
+ * @tparam BCL double buffered component list, components of CL that keep a previous tick buffer
  */
-template<typename CL, typename TL>
+template<typename CL, typename TL, typename BCL = component_list<>>
 struct ec_traits
 {
     using component_list                  = CL;
     using tag_list                        = TL;
+    using buffered_component_list         = BCL;
 
     using component_signature_storage_t         = std::bitset< yaecs::mpl::size_v<component_list> >;
     using tag_storage_per_entity_t              = std::bitset< yaecs::mpl::size_v<tag_list> >;
 
+    template<typename T>
+    using component_container_t                 = std::vector<T>;
+    template<typename T>
+    using entity_container_t                    = std::vector<T>;
+
+    /// true if containers have a compile time capacity and never allocate
+    constexpr static bool fixed_capacity_{false};
+
     template<typename T>
     static constexpr bool is_component(){
         return yaecs::mpl::contains_v<T, component_list>;
@@ -37,6 +53,27 @@ struct ec_traits
         return yaecs::mpl::contains_v<T, tag_list>;
     }
 
+    /**
+     * @brief Empty components are kept as signature bits only, they get no pool and no data index
+     * 
+     * @tparam T 
+     */
+    template<typename T>
+    static constexpr bool is_empty_component(){
+        return is_component<T>() && std::is_empty_v<T> && std::is_default_constructible_v<T>;
+    }
+
+    /**
+     * @brief Double buffered components keep a previous tick buffer next to the current one, empty components 
+     * are never double buffered
+     * 
+     * @tparam T 
+     */
+    template<typename T>
+    static constexpr bool is_double_buffered(){
+        return is_component<T>() && yaecs::mpl::contains_v<T, buffered_component_list> && !is_empty_component<T>();
+    }
+
     template<typename T>
     static constexpr int component_index(){
         if constexpr(yaecs::mpl::contains_v<T, component_list>){
@@ -57,6 +94,46 @@ struct ec_traits
         }
     }
 
+    /**
+     * @brief Signature mask with the bits of \tparam Ts set, usable in constant expressions
+     * 
+     * @tparam Ts The components
+     */
+    template<typename... Ts>
+    static constexpr component_signature_storage_t component_mask() noexcept{
+        static_assert(fits_word_mask(), "compile time masks support up to 64 components");
+        static_assert((is_component<Ts>() && ...), "Ts are not components");
+
+        return component_signature_storage_t{ (0ull | ... | (1ull << component_index<Ts>())) };
+    }
+
+    /**
+     * @brief True if component signatures fit into one 64 bit word, i.e. compile time masks are available
+     * 
+     */
+    static constexpr bool fits_word_mask(){
+        return component_count_ <= 64;
+    }
+
+    /**
+     * @brief Returns the slot of \tparam T in the per entity data index array, -1 for empty components
+     * 
+     * @tparam T 
+     */
+    template<typename T>
+    static constexpr int data_index_slot(){
+        static_assert(is_component<T>(), "T is not a component");
+        return data_index_slots_[yaecs::mpl::index_v<T, component_list>];
+    }
+
+    /**
+     * @brief Returns the count of components that are not empty, i.e. that have a pool and a data index
+     * 
+     */
+    static constexpr int stored_component_count(){
+        return stored_component_count_;
+    }
+
     static constexpr int tag_count(){
         return tag_count_;
     }
@@ -67,7 +144,47 @@ struct ec_traits
 
     constexpr static int component_count_{yaecs::mpl::size_v<component_list>};
     constexpr static int tag_count_{yaecs::mpl::size_v<tag_list>};
+
+private:
+    template<typename... Ts>
+    static constexpr std::array<int, sizeof...(Ts)> make_data_index_slots(yaecs::mpl::type_list<Ts...>){
+        std::array<int, sizeof...(Ts)> slots_{};
+        int next_slot_{0};
+        std::size_t i{0};
+        ((slots_[i++] = is_empty_component<Ts>() ? -1 : next_slot_++), ...);
+        return slots_;
+    }
+
+    constexpr static auto data_index_slots_{make_data_index_slots(component_list{})};
+    constexpr static int stored_component_count_{
+        static_cast<int>(std::count_if(data_index_slots_.begin(), data_index_slots_.end(), [](int slot){ return slot != -1; }))
+    };
 };
 
 
-} // namespace yaecs
\ No newline at end of file
+/**
+ * @brief Entity component traits of a fixed capacity engine, the entity table and every component pool 
+ * live in inline storage and never allocate
+ * 
+ * Engines built from these traits are as large as their capacities, give them static storage.
+ * 
+ * @tparam CL component list
+ * @tparam TL tag list
+ * @tparam MaxEntities entity table capacity
+ * @tparam MaxComponentInstances capacity of each component pool
+ * @tparam BCL double buffered component list
+ */
+template<typename CL, typename TL, std::size_t MaxEntities, std::size_t MaxComponentInstances, typename BCL = component_list<>>
+struct static_ec_traits : ec_traits<CL, TL, BCL>
+{
+    template<typename T>
+    using component_container_t                 = fixed_vector<T, MaxComponentInstances>;
+    template<typename T>
+    using entity_container_t                    = fixed_vector<T, MaxEntities>;
+
+    constexpr static bool fixed_capacity_{true};
+    constexpr static std::size_t max_entities_{MaxEntities};
+    constexpr static std::size_t max_component_instances_{MaxComponentInstances};
+};
+
+} // namespace yaecs
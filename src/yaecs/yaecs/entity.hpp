@@ -26,8 +26,33 @@ public:
     {
     }
 
+    /**
+     * @brief Copy of \param prototype with another id
+     * 
+     * @param id 
+     * @param prototype 
+     */
+    entity(std::uint32_t id, const entity& prototype)
+        : id_{id}
+        , signatures_{prototype.signatures_}
+        , data_index_per_component_{prototype.data_index_per_component_}
+        , tag_{prototype.tag_}
+    {
+    }
+
     std::uint32_t id() const noexcept{ return id_; }
 
+    /**
+     * @brief Adds \param offset to the data index of every component
+     * 
+     * @param offset 
+     */
+    void offset_data_indices(std::uint32_t offset) noexcept{
+        for(auto& data_index_ : data_index_per_component_){
+            data_index_ += offset;
+        }
+    }
+
     template<typename T>
     void set_signature(bool enabled){
         static_assert(ECT::template is_component<T>(), "T is not a component");
@@ -50,24 +75,51 @@ public:
         }
     }
 
+    [[nodiscard]] const component_signature_storage& signature() const noexcept{
+        return signatures_;
+    }
+
+    /**
+     * @brief Returns true if the entity has any component
+     * 
+     */
+    [[nodiscard]] bool any() const noexcept{
+        return signatures_.any();
+    }
+
     bool check(component_signature_storage other_signature) const noexcept{
         return (signatures_ & other_signature) == other_signature;
     }
 
     template<typename T>
-    void set_data_index(std::uint32_t data_index) noexcept{
+    void set_data_index([[maybe_unused]] std::uint32_t data_index) noexcept{
         static_assert(ECT::template is_component<T>(), "T is not a component");
 
-        constexpr auto component_index = ECT::template component_index<T>();
-
-        data_index_per_component_[component_index] = data_index;
+        if constexpr(!ECT::template is_empty_component<T>()){
+            constexpr auto data_index_slot = static_cast<std::size_t>(ECT::template data_index_slot<T>());
+            data_index_per_component_[data_index_slot] = data_index;
+        }
     }
 
     template<typename T>
     [[nodiscard]] std::uint32_t get_data_index() const noexcept{
         static_assert(ECT::template is_component<T>(), "T is not a component");
-        constexpr auto component_index = ECT::template component_index<T>();
-        return data_index_per_component_[component_index];
+
+        if constexpr(ECT::template is_empty_component<T>()){
+            return 0;
+        }
+        else{
+            constexpr auto data_index_slot = static_cast<std::size_t>(ECT::template data_index_slot<T>());
+            return data_index_per_component_[data_index_slot];
+        }
+    }
+
+    /**
+     * @brief Bytes each entity spends on its component data indices
+     * 
+     */
+    static constexpr std::size_t data_index_storage_size() noexcept{
+        return sizeof(data_index_per_component_);
     }
 
     [[nodiscard]] const int tag() const noexcept{
@@ -82,10 +134,14 @@ public:
         tag_ = tag_index;
     }
 
+    void clear_tag() noexcept{
+        tag_ = -1;
+    }
+
 private:
     std::uint32_t id_;
     component_signature_storage signatures_{false};
-    std::array<std::uint32_t, ECT::component_count()> data_index_per_component_{};
+    std::array<std::uint32_t, ECT::stored_component_count()> data_index_per_component_{};
     int tag_{-1};
 };
 
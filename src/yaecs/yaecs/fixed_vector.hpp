@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace yaecs{
+
+/**
+ * @brief Vector with inline storage for up to \tparam N elements, never allocates
+ *
+ * Elements are constructed on insertion only. Inserting into a full vector is a precondition violation,
+ * check full() first.
+ *
+ * @tparam T element type
+ * @tparam N capacity
+ */
+template<typename T, std::size_t N>
+class fixed_vector{
+public:
+    using value_type        = T;
+    using size_type         = std::size_t;
+    using iterator          = T*;
+    using const_iterator    = const T*;
+
+    fixed_vector() noexcept {}
+
+    fixed_vector(const fixed_vector& other){
+        for(const T& value_ : other){
+            push_back(value_);
+        }
+    }
+
+    fixed_vector(fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>){
+        for(T& value_ : other){
+            push_back(std::move(value_));
+        }
+        other.clear();
+    }
+
+    fixed_vector& operator=(const fixed_vector& other){
+        if(this != &other){
+            clear();
+            for(const T& value_ : other){
+                push_back(value_);
+            }
+        }
+        return *this;
+    }
+
+    fixed_vector& operator=(fixed_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>){
+        if(this != &other){
+            clear();
+            for(T& value_ : other){
+                push_back(std::move(value_));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~fixed_vector(){
+        clear();
+    }
+
+    static constexpr size_type capacity() noexcept{
+        return N;
+    }
+
+    [[nodiscard]] size_type size() const noexcept{
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept{
+        return size_ == 0;
+    }
+
+    [[nodiscard]] bool full() const noexcept{
+        return size_ == N;
+    }
+
+    /**
+     * @brief Capacity is fixed, only checks that \param n elements fit
+     *
+     * @param n
+     */
+    void reserve([[maybe_unused]] size_type n) const noexcept{
+        assert(n <= N);
+    }
+
+    void push_back(const T& value){
+        emplace_back(value);
+    }
+
+    void push_back(T&& value){
+        emplace_back(std::move(value));
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args){
+        assert(!full());
+
+        T* value_ = ::new (static_cast<void*>(storage_.data() + size_ * sizeof(T))) T(std::forward<Args>(args)...);
+        ++size_;
+        return *value_;
+    }
+
+    /**
+     * @brief Shrinks to or grows to \param count elements, new elements are copies of \param value
+     * 
+     * Trivially copyable values are copied bytewise.
+     *
+     * @param count
+     * @param value
+     */
+    void resize(size_type count, const T& value){
+        assert(count <= N);
+
+        while(size_ > count){
+            pop_back();
+        }
+
+        if constexpr(std::is_trivially_copyable_v<T>){
+            for(; size_ < count; ++size_){
+                std::memcpy(storage_.data() + size_ * sizeof(T), &value, sizeof(T));
+            }
+        }
+        else{
+            while(size_ < count){
+                emplace_back(value);
+            }
+        }
+    }
+
+    void pop_back() noexcept{
+        assert(!empty());
+
+        --size_;
+        element(size_)->~T();
+    }
+
+    void clear() noexcept{
+        while(!empty()){
+            pop_back();
+        }
+    }
+
+    /**
+     * @brief Returns the first element, only laundered when it exists
+     *
+     */
+    [[nodiscard]] T* data() noexcept{
+        return empty() ? reinterpret_cast<T*>(storage_.data()) : element(0);
+    }
+
+    [[nodiscard]] const T* data() const noexcept{
+        return empty() ? reinterpret_cast<const T*>(storage_.data()) : element(0);
+    }
+
+    [[nodiscard]] T& operator[](size_type index) noexcept{
+        assert(index < size_);
+        return *element(index);
+    }
+
+    [[nodiscard]] const T& operator[](size_type index) const noexcept{
+        assert(index < size_);
+        return *element(index);
+    }
+
+    iterator begin() noexcept{ return data(); }
+    iterator end() noexcept{ return data() + size_; }
+    const_iterator begin() const noexcept{ return data(); }
+    const_iterator end() const noexcept{ return data() + size_; }
+
+private:
+    T* element(size_type index) noexcept{
+        return std::launder(reinterpret_cast<T*>(storage_.data() + index * sizeof(T)));
+    }
+
+    const T* element(size_type index) const noexcept{
+        return std::launder(reinterpret_cast<const T*>(storage_.data() + index * sizeof(T)));
+    }
+
+    alignas(T) std::array<std::byte, sizeof(T) * N> storage_;
+    size_type size_{0};
+};
+
+} // namespace yaecs
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace yaecs{
+
+/**
+ * @brief Parent links of the entities and their depth sorted order
+ *
+ * order() lists every entity id by increasing depth (roots first), entities of the same depth are sorted by id.
+ * The order is rebuilt lazily in O(entity count) after the links change.
+ *
+ * @tparam ECT entity component traits
+ */
+template<typename ECT>
+class hierarchy{
+    using id_container_t = typename ECT::template entity_container_t<std::uint32_t>;
+
+public:
+    constexpr static std::uint32_t no_parent_{std::numeric_limits<std::uint32_t>::max()};
+
+    /**
+     * @brief Links \param child to \param parent, no_parent_ detaches it
+     *
+     * @param child
+     * @param parent
+     * @param entity_count
+     * @return false if \param child is \param parent or one of its ancestors, the link is not made then
+     */
+    bool set_parent(std::uint32_t child, std::uint32_t parent, std::uint32_t entity_count){
+        assert(child < entity_count);
+        assert(parent == no_parent_ || parent < entity_count);
+
+        if(parent == this->parent(child)){
+            return true;
+        }
+
+        if(is_ancestor(child, parent)) [[unlikely]] {
+            return false;
+        }
+
+        grow(entity_count);
+        link_count_ -= parents_[child] != no_parent_ ? 1u : 0u;
+        link_count_ += parent != no_parent_ ? 1u : 0u;
+        parents_[child] = parent;
+        dirty_ = true;
+        return true;
+    }
+
+    [[nodiscard]] std::uint32_t parent(std::uint32_t entity_id) const noexcept{
+        return entity_id < parents_.size() ? parents_[entity_id] : no_parent_;
+    }
+
+    /**
+     * @brief Returns the number of entities that have a parent
+     *
+     */
+    [[nodiscard]] std::uint32_t link_count() const noexcept{
+        return link_count_;
+    }
+
+    /**
+     * @brief Returns true if \param ancestor is \param entity_id or one of its ancestors
+     *
+     * @param ancestor
+     * @param entity_id
+     */
+    [[nodiscard]] bool is_ancestor(std::uint32_t ancestor, std::uint32_t entity_id) const noexcept{
+        for(auto id_ = entity_id; id_ != no_parent_; id_ = parent(id_)){
+            if(id_ == ancestor){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Rebuilds the depth order if the links or the entity count changed
+     *
+     * @param entity_count
+     * @param scratch holds the depths during the rebuild, left in an unspecified state
+     */
+    void update(std::uint32_t entity_count, std::vector<std::uint32_t>& scratch){
+        if(dirty_ || order_.size() != entity_count){
+            rebuild(entity_count, scratch);
+        }
+    }
+
+    [[nodiscard]] const id_container_t& order() const noexcept{
+        return order_;
+    }
+
+    [[nodiscard]] std::size_t level_count() const noexcept{
+        return level_ends_.size();
+    }
+
+    /**
+     * @brief Returns the [begin, end) range of the entities of depth \param level in order()
+     *
+     * @param level
+     */
+    [[nodiscard]] std::uint32_t level_begin(std::size_t level) const noexcept{
+        assert(level < level_ends_.size());
+        return level == 0 ? 0 : level_ends_[level - 1];
+    }
+
+    [[nodiscard]] std::uint32_t level_end(std::size_t level) const noexcept{
+        assert(level < level_ends_.size());
+        return level_ends_[level];
+    }
+
+    /**
+     * @brief Returns the bytes held by the links, the order and the level bounds
+     *
+     */
+    [[nodiscard]] std::size_t bytes() const noexcept{
+        return (parents_.capacity() + order_.capacity() + level_ends_.capacity()) * sizeof(std::uint32_t);
+    }
+
+    void clear() noexcept{
+        parents_.clear();
+        order_.clear();
+        level_ends_.clear();
+        link_count_ = 0;
+        dirty_ = false;
+    }
+
+private:
+    void grow(std::uint32_t entity_count){
+        while(parents_.size() < entity_count){
+            parents_.push_back(no_parent_);
+        }
+    }
+
+    void rebuild(std::uint32_t entity_count, std::vector<std::uint32_t>& depths){
+        grow(entity_count);
+
+        // depth of every entity, each chain of unknown depths is walked twice
+        constexpr auto unknown_ = std::numeric_limits<std::uint32_t>::max();
+        depths.assign(entity_count, unknown_);
+
+        std::uint32_t max_depth_{0};
+        for(std::uint32_t id = 0; id < entity_count; ++id){
+            std::uint32_t steps_{0};
+            auto top_ = id;
+            while(depths[top_] == unknown_ && parents_[top_] != no_parent_){
+                top_ = parents_[top_];
+                ++steps_;
+            }
+
+            auto depth_ = (depths[top_] == unknown_ ? 0 : depths[top_]) + steps_;
+            max_depth_ = depth_ > max_depth_ ? depth_ : max_depth_;
+            for(auto id_ = id; depths[id_] == unknown_; id_ = parents_[id_]){
+                depths[id_] = depth_--;
+                if(parents_[id_] == no_parent_){
+                    break;
+                }
+            }
+        }
+
+        // counting sort by depth
+        level_ends_.clear();
+        if(entity_count != 0){
+            for(std::uint32_t level = 0; level <= max_depth_; ++level){
+                level_ends_.push_back(0);
+            }
+        }
+        for(std::uint32_t id = 0; id < entity_count; ++id){
+            ++level_ends_[depths[id]];
+        }
+
+        // level_ends_ holds the level begins while scattering, each one is advanced to its level end
+        std::uint32_t begin_{0};
+        for(auto& level_end_ : level_ends_){
+            const auto count_ = level_end_;
+            level_end_ = begin_;
+            begin_ += count_;
+        }
+
+        order_.clear();
+        for(std::uint32_t id = 0; id < entity_count; ++id){
+            order_.push_back(0);
+        }
+        for(std::uint32_t id = 0; id < entity_count; ++id){
+            order_[level_ends_[depths[id]]++] = id;
+        }
+
+        dirty_ = false;
+    }
+
+private:
+    id_container_t parents_{};
+    id_container_t order_{};
+    id_container_t level_ends_{};
+    std::uint32_t link_count_{0};
+    bool dirty_{false};
+};
+
+} // namespace yaecs
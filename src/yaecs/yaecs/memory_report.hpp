@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace yaecs{
+
+/**
+ * @brief Memory usage of a single component pool
+ *
+ * Bytes only account for the pool itself, memory owned by the components (e.g. std::string) is not included.
+ */
+struct component_memory_info{
+    int component_index{-1};
+    std::size_t element_size{0};
+    std::size_t size{0};        ///< instances in the pool
+    std::size_t capacity{0};    ///< instances the pool can hold without growing
+    std::size_t bytes{0};       ///< capacity * element_size, double buffered: capacity * (2 * element_size + dirty flag size)
+    std::size_t live{0};        ///< instances referenced by an entity
+    std::size_t dead{0};        ///< instances no entity references anymore
+    double entity_fraction{0.0};///< live / entity count
+};
+
+/**
+ * @brief Memory usage of the entity table
+ *
+ */
+struct entity_table_memory_info{
+    std::size_t count{0};
+    std::size_t capacity{0};
+    std::size_t entity_size{0};
+    std::size_t bytes{0};            ///< capacity * entity_size
+    std::size_t data_index_bytes{0}; ///< part of bytes spent on the per entity data index arrays
+};
+
+/**
+ * @brief Memory usage of an ec_engine
+ *
+ */
+struct memory_report{
+    entity_table_memory_info entities{};
+    std::vector<component_memory_info> components{};
+    std::size_t hierarchy_bytes{0};  ///< parent links, depth order and level bounds
+    std::size_t scratch_bytes{0};    ///< reorder and hierarchy rebuild scratch
+
+    [[nodiscard]] std::size_t total_bytes() const noexcept{
+        std::size_t bytes_{entities.bytes + hierarchy_bytes + scratch_bytes};
+        for(const auto& component_ : components){
+            bytes_ += component_.bytes;
+        }
+        return bytes_;
+    }
+
+    /**
+     * @brief Human readable dump, one line per pool
+     *
+     * @return std::string
+     */
+    [[nodiscard]] std::string to_string() const{
+        std::ostringstream os_{};
+        os_ << "entities: count " << entities.count
+            << ", capacity " << entities.capacity
+            << ", entity size " << entities.entity_size
+            << ", bytes " << entities.bytes
+            << ", data index bytes " << entities.data_index_bytes << '\n';
+
+        for(const auto& c : components){
+            os_ << "component " << c.component_index
+                << ": element size " << c.element_size
+                << ", size " << c.size
+                << ", capacity " << c.capacity
+                << ", bytes " << c.bytes
+                << ", live " << c.live
+                << ", dead " << c.dead
+                << ", entity fraction " << c.entity_fraction << '\n';
+        }
+
+        os_ << "hierarchy bytes " << hierarchy_bytes << '\n'
+            << "scratch bytes " << scratch_bytes << '\n'
+            << "total bytes " << total_bytes() << '\n';
+        return os_.str();
+    }
+
+    /**
+     * @brief JSON dump
+     *
+     * @return std::string
+     */
+    [[nodiscard]] std::string to_json() const{
+        std::ostringstream os_{};
+        os_ << "{\"entities\":{"
+            << "\"count\":" << entities.count
+            << ",\"capacity\":" << entities.capacity
+            << ",\"entity_size\":" << entities.entity_size
+            << ",\"bytes\":" << entities.bytes
+            << ",\"data_index_bytes\":" << entities.data_index_bytes
+            << "},\"components\":[";
+
+        for(std::size_t i = 0; i < components.size(); ++i){
+            const auto& c = components[i];
+            os_ << (i == 0 ? "" : ",") << '{'
+                << "\"index\":" << c.component_index
+                << ",\"element_size\":" << c.element_size
+                << ",\"size\":" << c.size
+                << ",\"capacity\":" << c.capacity
+                << ",\"bytes\":" << c.bytes
+                << ",\"live\":" << c.live
+                << ",\"dead\":" << c.dead
+                << ",\"entity_fraction\":" << c.entity_fraction
+                << '}';
+        }
+
+        os_ << "],\"hierarchy_bytes\":" << hierarchy_bytes
+            << ",\"scratch_bytes\":" << scratch_bytes
+            << ",\"total_bytes\":" << total_bytes() << '}';
+        return os_.str();
+    }
+};
+
+} // namespace yaecs
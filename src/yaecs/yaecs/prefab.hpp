@@ -0,0 +1,69 @@
+#pragma once
+
+#include "entity.hpp"
+
+#include "../mpl/mpl.hpp"
+
+#include <optional>
+#include <tuple>
+
+namespace yaecs{
+
+/**
+ * @brief Template entity: a signature, a tag and one value per component, see ec_engine::instantiate
+ *
+ * @tparam ECT entity component traits
+ */
+template<typename ECT>
+class prefab{
+    using component_list = typename ECT::component_list;
+    using entity_t = entity<ECT>;
+
+    template<typename... Ts>
+    static std::tuple<std::optional<Ts>...> to_tuple(yaecs::mpl::type_list<Ts...>);
+
+    using values_t = decltype(to_tuple(std::declval<component_list>()));
+
+public:
+
+    /**
+     * @brief Sets the \tparam T value given to every instance
+     *
+     * @tparam T Component Type
+     * @param c
+     */
+    template<typename T>
+    void set(T c){
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        prototype_.template set_signature<T>(true);
+        std::get<std::optional<T>>(values_) = std::move(c);
+    }
+
+    template<typename T>
+    [[nodiscard]] bool has() const noexcept{
+        return prototype_.template get_signature<T>();
+    }
+
+    template<typename T>
+    [[nodiscard]] const T& get() const noexcept{
+        static_assert(ECT::template is_component<T>(), "T is not a component");
+
+        return *std::get<std::optional<T>>(values_);
+    }
+
+    template<typename Tag>
+    void set_tag() noexcept{
+        prototype_.template set_tag<Tag>();
+    }
+
+    [[nodiscard]] const entity_t& prototype() const noexcept{
+        return prototype_;
+    }
+
+private:
+    entity_t prototype_{0};
+    values_t values_{};
+};
+
+} // namespace yaecs
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "../mpl/mpl.hpp"
+
+namespace yaecs{
+
+/**
+ * @brief Query filter, entity must have all of \tparam Ts, they are passed to the query callable
+ */
+template<typename... Ts>
+struct with{
+    using with_list     = yaecs::mpl::type_list<Ts...>;
+    using without_list  = yaecs::mpl::type_list<>;
+    using any_of_list   = yaecs::mpl::type_list<>;
+    using tag_list      = yaecs::mpl::type_list<>;
+};
+
+/**
+ * @brief Query filter, entity must have none of \tparam Ts
+ */
+template<typename... Ts>
+struct without{
+    using with_list     = yaecs::mpl::type_list<>;
+    using without_list  = yaecs::mpl::type_list<Ts...>;
+    using any_of_list   = yaecs::mpl::type_list<>;
+    using tag_list      = yaecs::mpl::type_list<>;
+};
+
+/**
+ * @brief Query filter, entity must have at least one of \tparam Ts
+ */
+template<typename... Ts>
+struct any_of{
+    using with_list     = yaecs::mpl::type_list<>;
+    using without_list  = yaecs::mpl::type_list<>;
+    using any_of_list   = yaecs::mpl::type_list<Ts...>;
+    using tag_list      = yaecs::mpl::type_list<>;
+};
+
+/**
+ * @brief Query filter, entity must be tagged with \tparam Tag
+ */
+template<typename Tag>
+struct tagged{
+    using with_list     = yaecs::mpl::type_list<>;
+    using without_list  = yaecs::mpl::type_list<>;
+    using any_of_list   = yaecs::mpl::type_list<>;
+    using tag_list      = yaecs::mpl::type_list<Tag>;
+};
+
+/**
+ * @brief Entity query, e.g. query<with<A, B>, without<C>, any_of<D, E>, tagged<T>>
+ *
+ * @tparam Filters with, without, any_of, tagged
+ */
+template<typename... Filters>
+struct query{
+    using with_list     = yaecs::mpl::concat_t<typename Filters::with_list...>;
+    using without_list  = yaecs::mpl::concat_t<typename Filters::without_list...>;
+    using any_of_list   = yaecs::mpl::concat_t<typename Filters::any_of_list...>;
+    using tag_list      = yaecs::mpl::concat_t<typename Filters::tag_list...>;
+
+    static_assert(yaecs::mpl::size_v<tag_list> <= 1, "a query can only match one tag");
+};
+
+/**
+ * @brief Query masks folded at compile time
+ *
+ * @tparam ECT entity component traits
+ * @tparam Q query<...>
+ */
+template<typename ECT, typename Q>
+struct query_traits{
+private:
+    using component_signature_storage_t = typename ECT::component_signature_storage_t;
+
+    template<typename... Ts>
+    static constexpr component_signature_storage_t mask_of(yaecs::mpl::type_list<Ts...>) noexcept{
+        return ECT::template component_mask<Ts...>();
+    }
+
+    template<typename... Ts>
+    static constexpr int tag_index_of(yaecs::mpl::type_list<Ts...>) noexcept{
+        if constexpr(sizeof...(Ts) == 0){
+            return -1;
+        }
+        else{
+            static_assert((ECT::template is_tag<Ts>() && ...), "tparam of tagged is not a tag");
+            return (ECT::template tag_index<Ts>() + ...);
+        }
+    }
+
+public:
+    using component_list = typename Q::with_list;
+
+    constexpr static component_signature_storage_t with_mask_{mask_of(typename Q::with_list{})};
+    constexpr static component_signature_storage_t without_mask_{mask_of(typename Q::without_list{})};
+    constexpr static component_signature_storage_t any_of_mask_{mask_of(typename Q::any_of_list{})};
+    constexpr static int tag_index_{tag_index_of(typename Q::tag_list{})};
+
+    constexpr static bool has_without_{yaecs::mpl::size_v<typename Q::without_list> != 0};
+    constexpr static bool has_any_of_{yaecs::mpl::size_v<typename Q::any_of_list> != 0};
+    constexpr static bool has_tag_{tag_index_ != -1};
+
+    /**
+     * @brief Tests a signature and tag against the query, without branching on the individual filters
+     *
+     * @param sig entity signature
+     * @param tag entity tag index
+     */
+    static bool matches(const component_signature_storage_t& sig, int tag) noexcept{
+        bool match_ = (sig & with_mask_) == with_mask_;
+        if constexpr(has_without_){
+            match_ &= (sig & without_mask_).none();
+        }
+        if constexpr(has_any_of_){
+            match_ &= (sig & any_of_mask_).any();
+        }
+        if constexpr(has_tag_){
+            match_ &= tag == tag_index_;
+        }
+        return match_;
+    }
+};
+
+} // namespace yaecs
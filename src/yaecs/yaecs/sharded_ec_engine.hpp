@@ -0,0 +1,420 @@
+#pragma once
+
+#include "ec_traits.hpp"
+#include "ec_engine.hpp"
+
+#include "../mpl/mpl.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <latch>
+#include <thread>
+#include <vector>
+
+namespace yaecs{
+
+/**
+ * @brief Set of independent entity component engines (shards)
+ *
+ * Every shard owns its own entity table and component pools, nothing is shared between shards,
+ * so each shard can be updated by its own thread. Shards start on their own cache line, threads updating
+ * neighbouring shards do not share one.
+ *
+ * Pools and entity tables use the containers of \tparam ECT with their default allocator, there is no per shard
+ * allocator. Memory is placed on the NUMA node of the thread that first writes it, so to keep a shard on one node
+ * create its entities and add its components from a worker pinned to that node, see the executor overload of
+ * parallel_for_each_shard. Growing a shard from another thread places the new memory on that thread's node.
+ *
+ * Entity handles returned by the sharded engine
+ * encode the shard in their upper bits and the shard local entity id in the lower bits.
+ *
+ * @tparam ECT entity component traits
+ * @tparam ShardCount number of shards
+ */
+template<typename ECT, std::size_t ShardCount>
+class sharded_ec_engine{
+    static_assert(ShardCount > 0, "ShardCount must be greater than zero");
+
+    using ec_traits_type = ECT;
+    using component_list = typename ec_traits_type::component_list;
+    using tag_list       = typename ec_traits_type::tag_list;
+
+public:
+    using engine_t = ec_engine<ec_traits_type>;
+
+    /// fixed rather than std::hardware_destructive_interference_size, which may differ between translation units
+    constexpr static std::size_t cache_line_size_{64};
+
+    constexpr static std::uint32_t shard_bits_{static_cast<std::uint32_t>(std::bit_width(ShardCount - 1))};
+    constexpr static std::uint32_t local_bits_{32u - shard_bits_};
+    constexpr static std::uint32_t local_mask_{shard_bits_ == 0 ? ~0u : (1u << local_bits_) - 1u};
+
+    /// local ids stay below local_mask_, so invalid_handle_ never decodes to an issued entity
+    constexpr static std::uint32_t max_local_entities_{local_mask_};
+
+    /// returned when a shard is full
+    constexpr static std::uint32_t invalid_handle_{engine_t::invalid_entity_id_};
+
+    /**
+     * @brief Returns the shard count
+     *
+     * @return std::size_t
+     */
+    static constexpr std::size_t shard_count() noexcept{
+        return ShardCount;
+    }
+
+    /**
+     * @brief Builds an entity handle from a shard index and a shard local entity id
+     *
+     * @param shard_index
+     * @param local_id
+     * @return std::uint32_t Entity handle
+     */
+    static constexpr std::uint32_t make_handle(std::size_t shard_index, std::uint32_t local_id) noexcept{
+        assert(shard_index < ShardCount);
+        assert(local_id < max_local_entities_);
+
+        if constexpr(shard_bits_ == 0){
+            return local_id;
+        }
+        else{
+            return (static_cast<std::uint32_t>(shard_index) << local_bits_) | local_id;
+        }
+    }
+
+    /**
+     * @brief Returns the shard index encoded in \param handle
+     *
+     * @param handle
+     * @return std::size_t
+     */
+    static constexpr std::size_t shard_of(std::uint32_t handle) noexcept{
+        if constexpr(shard_bits_ == 0){
+            return 0;
+        }
+        else{
+            return static_cast<std::size_t>(handle >> local_bits_);
+        }
+    }
+
+    /**
+     * @brief Returns the shard local entity id encoded in \param handle
+     *
+     * @param handle
+     * @return std::uint32_t
+     */
+    static constexpr std::uint32_t local_id_of(std::uint32_t handle) noexcept{
+        return handle & local_mask_;
+    }
+
+    /**
+     * @brief Returns the shard at \param shard_index
+     *
+     * @param shard_index
+     * @return engine_t&
+     */
+    engine_t& shard(std::size_t shard_index) noexcept{
+        assert(shard_index < ShardCount);
+        return shards_[shard_index].engine;
+    }
+
+    const engine_t& shard(std::size_t shard_index) const noexcept{
+        assert(shard_index < ShardCount);
+        return shards_[shard_index].engine;
+    }
+
+    /**
+     * @brief Creates an entity in the given shard
+     *
+     * @param shard_index
+     * @return std::uint32_t Entity handle, invalid_handle_ if the shard is full or a fixed capacity shard is full
+     */
+    std::uint32_t create_entity(std::size_t shard_index) noexcept{
+        engine_t& shard_ = shard(shard_index);
+        if(shard_.entity_count() >= max_local_entities_) [[unlikely]] {
+            return invalid_handle_;
+        }
+
+        const auto local_id_ = shard_.create_entity();
+        if(local_id_ == engine_t::invalid_entity_id_) [[unlikely]] {
+            return invalid_handle_;
+        }
+        return make_handle(shard_index, local_id_);
+    }
+
+    /**
+     * @brief Returns the total entity count of all shards
+     *
+     * @return std::uint32_t
+     */
+    std::uint32_t entity_count() const noexcept{
+        std::uint32_t count_{0};
+        for(const shard_slot& slot_ : shards_){
+            count_ += slot_.engine.entity_count();
+        }
+        return count_;
+    }
+
+    template<typename Tag>
+    void add_tag(std::uint32_t handle) noexcept{
+        shard(shard_of(handle)).template add_tag<Tag>(local_id_of(handle));
+    }
+
+    template<typename T>
+    bool add_component(std::uint32_t handle, T c){
+        return shard(shard_of(handle)).template add_component<T>(local_id_of(handle), std::move(c));
+    }
+
+    template<typename T>
+    bool add_component(std::uint32_t handle){
+        return shard(shard_of(handle)).template add_component<T>(local_id_of(handle));
+    }
+
+    template<typename T>
+    [[nodiscard]] bool has_component(std::uint32_t handle) const noexcept{
+        return shard(shard_of(handle)).template has_component<T>(local_id_of(handle));
+    }
+
+    template<typename T>
+    [[nodiscard]] T& get_component(std::uint32_t handle) noexcept{
+        return shard(shard_of(handle)).template get_component<T>(local_id_of(handle));
+    }
+
+    /**
+     * @brief Invokes \param c with (shard index, shard) for every shard, sequentially
+     *
+     * @tparam callable
+     * @param c
+     */
+    template<class callable>
+    void for_each_shard(callable c){
+        for(std::size_t i = 0; i < ShardCount; ++i){
+            c(i, shards_[i].engine);
+        }
+    }
+
+    /**
+     * @brief Invokes \param c with (shard index, shard) for every shard, one thread per shard
+     *
+     * Returns when every shard is processed. \param c must only touch the shard it is given.
+     * The threads are started for this call only, see the executor overload to run on long lived workers.
+     *
+     * @tparam callable
+     * @param c
+     */
+    template<class callable>
+    void parallel_for_each_shard(callable c){
+        std::vector<std::thread> workers_{};
+        workers_.reserve(ShardCount - 1);
+
+        for(std::size_t i = 1; i < ShardCount; ++i){
+            workers_.emplace_back([&c, this, i](){ c(i, shards_[i].engine); });
+        }
+
+        c(std::size_t{0}, shards_[0].engine);
+
+        for(std::thread& worker_ : workers_){
+            worker_.join();
+        }
+    }
+
+    /**
+     * @brief Invokes \param c with (shard index, shard) for every shard on caller owned workers
+     *
+     * \param e is invoked with (shard index, task) for every shard and must run task once, on any thread,
+     * e.g. by handing it to a persistent worker pinned for that shard. Returns when every task is done.
+     *
+     * @tparam executor
+     * @tparam callable
+     * @param e
+     * @param c
+     */
+    template<class executor, class callable>
+    void parallel_for_each_shard(executor&& e, callable c){
+        std::latch done_{static_cast<std::ptrdiff_t>(ShardCount)};
+
+        for(std::size_t i = 0; i < ShardCount; ++i){
+            e(i, [&c, &done_, this, i](){
+                c(i, shards_[i].engine);
+                done_.count_down();
+            });
+        }
+
+        done_.wait();
+    }
+
+    /**
+     * @brief Fans the query out to every shard
+     *
+     * @tparam Ts The components
+     * @tparam callable
+     * @param c
+     */
+    template<typename... Ts, class callable>
+    void for_matching_entities(callable c){
+        for(shard_slot& slot_ : shards_){
+            slot_.engine.template for_matching_entities<Ts...>(c);
+        }
+    }
+
+    /**
+     * @brief Moves the entity with all its components and tag into another shard
+     *
+     * The source entity is left without components and tag, its id is not reused. Parent links do not cross
+     * shards: the moved entity has no parent and its children in the source shard are detached, which scans
+     * the source shard once if it has any link. See merge to keep the links of a whole shard.
+     *
+     * @param handle
+     * @param dst_shard_index
+     * @return std::uint32_t New entity handle, invalid_handle_ if the entity does not fit into the 
+     * destination shard, the entity is left unchanged then
+     */
+    std::uint32_t migrate(std::uint32_t handle, std::size_t dst_shard_index){
+        const auto src_shard_index = shard_of(handle);
+        if(src_shard_index == dst_shard_index){
+            return handle;
+        }
+
+        engine_t& src_ = shard(src_shard_index);
+        engine_t& dst_ = shard(dst_shard_index);
+        const auto src_id = local_id_of(handle);
+
+        bool fits_{true};
+        yaecs::mpl::for_each_type<component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            fits_ = fits_ && (!src_.template has_component<T>(src_id) || dst_.template can_add_component<T>());
+        });
+
+        const auto dst_handle = fits_ ? create_entity(dst_shard_index) : invalid_handle_;
+        if(dst_handle == invalid_handle_) [[unlikely]] {
+            return invalid_handle_;
+        }
+
+        move_entity(src_, src_id, dst_, local_id_of(dst_handle));
+
+        // shards without links, the common case, skip the scan for children
+        if(src_.parent_link_count() != 0){
+            src_.remove_parent(src_id);
+            for(std::uint32_t id = 0; id < src_.entity_count(); ++id){
+                if(src_.parent(id) == src_id){
+                    src_.remove_parent(id);
+                }
+            }
+        }
+
+        return dst_handle;
+    }
+
+    /**
+     * @brief Migrates every entity of \param src_shard_index that has a component, a tag or a parent link into
+     * \param dst_shard_index and clears the source shard
+     *
+     * Parent links between the migrated entities are kept.
+     *
+     * @tparam callable
+     * @param dst_shard_index
+     * @param src_shard_index
+     * @param c Invoked with (old handle, new handle) for every migrated entity
+     * @return false if the entities do not fit into the destination shard, both shards are left unchanged then
+     */
+    template<class callable>
+    bool merge(std::size_t dst_shard_index, std::size_t src_shard_index, callable c){
+        if(src_shard_index == dst_shard_index){
+            return true;
+        }
+
+        engine_t& src_ = shard(src_shard_index);
+        engine_t& dst_ = shard(dst_shard_index);
+
+        // old local id -> new local id, parents of migrated entities are migrated too
+        std::vector<std::uint32_t> new_ids_(src_.entity_count(), engine_t::invalid_entity_id_);
+        constexpr auto migrated_{engine_t::invalid_entity_id_ - 1};
+
+        for(std::uint32_t id = 0; id < src_.entity_count(); ++id){
+            const auto& entity_ = src_.get_entity(id);
+            const auto parent_ = src_.parent(id);
+            if(entity_.any() || entity_.tag() != -1 || parent_ != engine_t::invalid_entity_id_){
+                new_ids_[id] = migrated_;
+            }
+            if(parent_ != engine_t::invalid_entity_id_){
+                new_ids_[parent_] = migrated_;
+            }
+        }
+
+        const auto count_ = static_cast<std::uint32_t>(std::count(new_ids_.begin(), new_ids_.end(), migrated_));
+
+        bool fits_{count_ <= max_local_entities_ - dst_.entity_count() && dst_.can_create_entities(count_)};
+        yaecs::mpl::for_each_type<component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+
+            std::size_t instances_{0};
+            for(std::uint32_t id = 0; fits_ && id < src_.entity_count(); ++id){
+                instances_ += src_.template has_component<T>(id) ? 1u : 0u;
+            }
+            fits_ = fits_ && dst_.template can_add_component<T>(instances_);
+        });
+
+        if(!fits_) [[unlikely]] {
+            return false;
+        }
+
+        for(std::uint32_t id = 0; id < src_.entity_count(); ++id){
+            if(new_ids_[id] == migrated_){
+                new_ids_[id] = dst_.create_entity();
+                move_entity(src_, id, dst_, new_ids_[id]);
+                c(make_handle(src_shard_index, id), make_handle(dst_shard_index, new_ids_[id]));
+            }
+        }
+
+        // the links are a forest in the source shard, they can not form a cycle in the destination
+        for(std::uint32_t id = 0; id < src_.entity_count(); ++id){
+            const auto parent_ = src_.parent(id);
+            if(parent_ != engine_t::invalid_entity_id_){
+                [[maybe_unused]] const bool linked_ = dst_.set_parent(new_ids_[id], new_ids_[parent_]);
+                assert(linked_);
+            }
+        }
+
+        src_.clear();
+        return true;
+    }
+
+    bool merge(std::size_t dst_shard_index, std::size_t src_shard_index){
+        return merge(dst_shard_index, src_shard_index, [](std::uint32_t, std::uint32_t){});
+    }
+
+private:
+    /**
+     * @brief Moves the components and the tag of \param src_id to \param dst_id, the pools of \param dst must have room
+     */
+    static void move_entity(engine_t& src, std::uint32_t src_id, engine_t& dst, std::uint32_t dst_id){
+        yaecs::mpl::for_each_type<component_list>([&](auto type){
+            using T = typename decltype(type)::type;
+            if(src.template has_component<T>(src_id)){
+                dst.template add_component<T>(dst_id, std::move(src.template get_component<T>(src_id)));
+                src.template remove_component<T>(src_id);
+            }
+        });
+
+        const int tag_ = src.get_entity(src_id).tag();
+        yaecs::mpl::for_each_type<tag_list>([&](auto type){
+            using Tag = typename decltype(type)::type;
+            if(ec_traits_type::template tag_index<Tag>() == tag_){
+                dst.template add_tag<Tag>(dst_id);
+            }
+        });
+        src.clear_tag(src_id);
+    }
+
+    struct alignas(cache_line_size_) shard_slot{
+        engine_t engine{};
+    };
+
+    std::array<shard_slot, ShardCount> shards_{};
+};
+
+} // namespace yaecs
@@ -3,10 +3,14 @@
 #include <yaecs/yaecs.hpp>
 #include <yaecs/mpl/mpl.hpp>
 
+#include <algorithm>
 #include <type_traits>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <functional>
+#include <memory>
 
 TEST(Entitytests, entity)
 {
@@ -184,6 +188,14 @@ TEST(mpl_tests, mpl_tt)
   auto s1 = yaecs::mpl::size_v<tl>;
   EXPECT_EQ(s1, static_cast<std::size_t>(3));
 
+  auto reader_ = [](const T1&, T2){};
+  auto writer_ = [](const T1&, T2&){};
+  auto generic_ = [](const auto&){};
+  static_assert(yaecs::mpl::reads_only_v<decltype(reader_)>);
+  static_assert(!yaecs::mpl::reads_only_v<decltype(writer_)>);
+  static_assert(!yaecs::mpl::reads_only_v<decltype(generic_)>);
+  static_assert(yaecs::mpl::reads_only_v<void(*)(const T3&)>);
+
   auto i1 = yaecs::mpl::index_v<T1, tl>;
   EXPECT_EQ(i1, static_cast<std::size_t>(0));
   auto i2 = yaecs::mpl::index_v<T2, tl>;
@@ -348,4 +360,983 @@ TEST(ec_engine_system_tests, ec_engine_system)
 
   engine_.each_matching_tag<particle_tag, decltype(particle_handle2), position, shader>(particle_handle2);
 
-}
\ No newline at end of file
+}
+
+TEST(sharded_ec_engine_tests, sharded_ec_engine)
+{
+  struct position{
+    float x;
+    float y;
+  };
+
+  struct velocity{
+    float dx;
+    float dy;
+  };
+
+  // Tags
+  struct player_tag{};
+  struct npc_tag{};
+
+  using components = yaecs::component_list<position, velocity>;
+  using tags = yaecs::tag_list<player_tag, npc_tag>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using sharded_engine_t = yaecs::sharded_ec_engine<ec_traits_t, 4>;
+
+  EXPECT_EQ(sharded_engine_t::shard_bits_, static_cast<std::uint32_t>(2));
+
+  auto h1 = sharded_engine_t::make_handle(3, 17);
+  EXPECT_EQ(sharded_engine_t::shard_of(h1), static_cast<std::size_t>(3));
+  EXPECT_EQ(sharded_engine_t::local_id_of(h1), static_cast<std::uint32_t>(17));
+
+  sharded_engine_t engine_{};
+
+  for(std::size_t s = 0; s < sharded_engine_t::shard_count(); ++s){
+    for(int i = 0; i < 10; ++i){
+      auto e = engine_.create_entity(s);
+      EXPECT_EQ(sharded_engine_t::shard_of(e), s);
+      engine_.add_component<position>(e, position{static_cast<float>(i), 0.0f});
+      engine_.add_component<velocity>(e, velocity{1.0f, 2.0f});
+    }
+  }
+
+  EXPECT_EQ(engine_.entity_count(), static_cast<std::uint32_t>(40));
+
+  engine_.parallel_for_each_shard([](std::size_t, sharded_engine_t::engine_t& shard){
+    shard.for_matching_entities<position, velocity>([](position& pos, velocity& vel){
+      pos.x += vel.dx;
+      pos.y += vel.dy;
+    });
+  });
+
+  int visited_{0};
+  engine_.for_matching_entities<position>([&](position& pos){
+    EXPECT_EQ(pos.y, 2.0f);
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 40);
+
+  // shards do not share cache lines
+  for(std::size_t s = 0; s < sharded_engine_t::shard_count(); ++s){
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&engine_.shard(s)) % sharded_engine_t::cache_line_size_, static_cast<std::uintptr_t>(0));
+  }
+
+  // caller owned workers
+  std::vector<std::thread> workers_{};
+  engine_.parallel_for_each_shard([&](std::size_t, auto task){ workers_.emplace_back(task); },
+    [](std::size_t, sharded_engine_t::engine_t& shard){
+      shard.for_matching_entities<position, velocity>([](position& pos, velocity& vel){
+        pos.y += vel.dy;
+      });
+    });
+  for(std::thread& worker_ : workers_){
+    worker_.join();
+  }
+  EXPECT_EQ(workers_.size(), sharded_engine_t::shard_count());
+
+  engine_.for_matching_entities<position>([&](position& pos){
+    EXPECT_EQ(pos.y, 4.0f);
+  });
+
+  // shard local creation, every shard grows from its own worker
+  sharded_engine_t local_{};
+  std::vector<std::thread> creators_{};
+  local_.parallel_for_each_shard([&](std::size_t, auto task){ creators_.emplace_back(task); },
+    [](std::size_t shard_index, sharded_engine_t::engine_t& shard){
+      for(std::uint32_t i = 0; i < 100; ++i){
+        shard.add_component<position>(shard.create_entity(), position{static_cast<float>(shard_index), 0.0f});
+      }
+    });
+  for(std::thread& creator_ : creators_){
+    creator_.join();
+  }
+  EXPECT_EQ(local_.entity_count(), static_cast<std::uint32_t>(400));
+  EXPECT_EQ(local_.get_component<position>(sharded_engine_t::make_handle(3, 99)).x, 3.0f);
+
+  // migration
+  auto e1 = sharded_engine_t::make_handle(1, 4);
+  engine_.add_tag<npc_tag>(e1);
+  auto e1_moved = engine_.migrate(e1, 2);
+
+  EXPECT_EQ(sharded_engine_t::shard_of(e1_moved), static_cast<std::size_t>(2));
+  EXPECT_EQ(engine_.has_component<position>(e1), false);
+  EXPECT_EQ(engine_.has_component<position>(e1_moved), true);
+  EXPECT_EQ(engine_.get_component<position>(e1_moved).x, 5.0f);
+  EXPECT_EQ(engine_.shard(2).get_entity(sharded_engine_t::local_id_of(e1_moved)).tag(), 1);
+  EXPECT_EQ(engine_.shard(1).get_entity(4).tag(), -1);
+
+  // merge
+  int remapped_{0};
+  engine_.merge(0, 1, [&](std::uint32_t old_handle, std::uint32_t new_handle){
+    EXPECT_EQ(sharded_engine_t::shard_of(old_handle), static_cast<std::size_t>(1));
+    EXPECT_EQ(sharded_engine_t::shard_of(new_handle), static_cast<std::size_t>(0));
+    ++remapped_;
+  });
+
+  EXPECT_EQ(remapped_, 9);
+  EXPECT_EQ(engine_.shard(1).entity_count(), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(engine_.shard(0).entity_count(), static_cast<std::uint32_t>(19));
+
+  visited_ = 0;
+  engine_.for_matching_entities<position, velocity>([&](position&, velocity&){
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 40);
+
+  // parent links: migrate detaches, merge keeps them
+  sharded_engine_t linked_{};
+  for(std::uint32_t i = 0; i < 3; ++i){
+    linked_.add_component<position>(linked_.create_entity(0), position{static_cast<float>(i), 0.0f});
+  }
+  linked_.shard(0).set_parent(1, 0);
+  linked_.shard(0).set_parent(2, 0);
+  linked_.shard(0).set_parent(0, linked_.shard(0).create_entity());
+  EXPECT_EQ(linked_.shard(0).parent_link_count(), static_cast<std::uint32_t>(3));
+
+  auto root_moved_ = linked_.migrate(sharded_engine_t::make_handle(0, 0), 1);
+  EXPECT_EQ(linked_.shard(1).parent(sharded_engine_t::local_id_of(root_moved_)), sharded_engine_t::engine_t::invalid_entity_id_);
+  EXPECT_EQ(linked_.shard(0).parent(0), sharded_engine_t::engine_t::invalid_entity_id_);
+  EXPECT_EQ(linked_.shard(0).parent(1), sharded_engine_t::engine_t::invalid_entity_id_);
+  EXPECT_EQ(linked_.shard(0).parent(2), sharded_engine_t::engine_t::invalid_entity_id_);
+  EXPECT_EQ(linked_.shard(0).parent_link_count(), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(linked_.shard(1).parent_link_count(), static_cast<std::uint32_t>(0));
+
+  //   3 -> 2 -> 1 -> 0, 3 has neither a component nor a tag
+  for(std::uint32_t i = 0; i < 4; ++i){
+    auto e = linked_.create_entity(2);
+    if(i != 3){
+      linked_.add_component<position>(e, position{static_cast<float>(i), 0.0f});
+    }
+  }
+  for(std::uint32_t i = 0; i < 3; ++i){
+    linked_.shard(2).set_parent(i, i + 1);
+  }
+
+  std::vector<std::uint32_t> new_ids_(4, sharded_engine_t::invalid_handle_);
+  EXPECT_TRUE(linked_.merge(1, 2, [&](std::uint32_t old_handle, std::uint32_t new_handle){
+    new_ids_[sharded_engine_t::local_id_of(old_handle)] = sharded_engine_t::local_id_of(new_handle);
+  }));
+  for(std::uint32_t i = 0; i < 3; ++i){
+    EXPECT_EQ(linked_.shard(1).parent(new_ids_[i]), new_ids_[i + 1]);
+    EXPECT_EQ(linked_.shard(1).get_component<position>(new_ids_[i]).x, static_cast<float>(i));
+  }
+  EXPECT_EQ(linked_.shard(1).parent(new_ids_[3]), sharded_engine_t::engine_t::invalid_entity_id_);
+  EXPECT_EQ(linked_.shard(1).update_hierarchy(), static_cast<std::size_t>(4));
+
+  // a shard never hands out more ids than the handle can encode
+  using wide_engine_t = yaecs::sharded_ec_engine<ec_traits_t, 65536>;
+  EXPECT_EQ(wide_engine_t::max_local_entities_, static_cast<std::uint32_t>(65535));
+  EXPECT_EQ(wide_engine_t::local_id_of(wide_engine_t::invalid_handle_), wide_engine_t::max_local_entities_);
+
+  auto wide_ = std::make_unique<wide_engine_t>();
+  for(std::uint32_t i = 0; i < wide_engine_t::max_local_entities_; ++i){
+    EXPECT_EQ(wide_->create_entity(0), i);
+  }
+  EXPECT_EQ(wide_->create_entity(0), wide_engine_t::invalid_handle_);
+  EXPECT_EQ(wide_->shard(0).entity_count(), wide_engine_t::max_local_entities_);
+  EXPECT_EQ(wide_->shard(1).entity_count(), static_cast<std::uint32_t>(0));
+}
+
+
+TEST(ec_engine_memory_report_tests, ec_engine_memory_report)
+{
+  struct position{
+    float x;
+    float y;
+    float z;
+  };
+
+  struct health{
+    std::int32_t hp;
+  };
+
+  struct tag1{};
+
+  using components = yaecs::component_list<position, health>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  for(int i = 0; i < 8; ++i){
+    auto e = engine_.create_entity();
+    engine_.add_component<position>(e);
+    if(i % 2 == 0){
+      engine_.add_component<health>(e, health{i});
+    }
+  }
+
+  engine_.remove_component<position>(3);
+
+  auto report_ = engine_.memory_usage();
+
+  EXPECT_EQ(report_.entities.count, static_cast<std::size_t>(8));
+  EXPECT_EQ(report_.entities.data_index_bytes, report_.entities.capacity * 2 * sizeof(std::uint32_t));
+  ASSERT_EQ(report_.components.size(), static_cast<std::size_t>(2));
+
+  const auto& pos_info_ = report_.components[0];
+  EXPECT_EQ(pos_info_.component_index, 0);
+  EXPECT_EQ(pos_info_.element_size, sizeof(position));
+  EXPECT_EQ(pos_info_.size, static_cast<std::size_t>(8));
+  EXPECT_EQ(pos_info_.live, static_cast<std::size_t>(7));
+  EXPECT_EQ(pos_info_.dead, static_cast<std::size_t>(1));
+  EXPECT_EQ(pos_info_.bytes, pos_info_.capacity * sizeof(position));
+
+  const auto& health_info_ = report_.components[1];
+  EXPECT_EQ(health_info_.live, static_cast<std::size_t>(4));
+  EXPECT_EQ(health_info_.entity_fraction, 0.5);
+
+  EXPECT_EQ(report_.hierarchy_bytes, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.total_bytes(), report_.entities.bytes + pos_info_.bytes + health_info_.bytes + report_.scratch_bytes);
+
+  // the hierarchy holds links, order and level bounds, the rebuild uses the scratch buffer
+  engine_.set_parent(1, 0);
+  engine_.update_hierarchy();
+  const auto linked_report_ = engine_.memory_usage();
+  EXPECT_GE(linked_report_.hierarchy_bytes, (2 * 8 + 2) * sizeof(std::uint32_t));
+  EXPECT_GE(linked_report_.scratch_bytes, 8 * sizeof(std::uint32_t));
+  EXPECT_EQ(linked_report_.total_bytes(), report_.total_bytes() - report_.scratch_bytes + linked_report_.hierarchy_bytes + linked_report_.scratch_bytes);
+
+  auto json_ = linked_report_.to_json();
+  EXPECT_NE(json_.find("\"dead\":1"), std::string::npos);
+  EXPECT_NE(json_.find("\"hierarchy_bytes\":"), std::string::npos);
+  EXPECT_NE(report_.to_string().find("component 1"), std::string::npos);
+}
+
+
+TEST(ec_engine_compaction_tests, ec_engine_compaction)
+{
+  struct position{
+    float x;
+  };
+
+  struct name{
+    std::string s;
+  };
+
+  struct tag1{};
+
+  using components = yaecs::component_list<position, name>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  constexpr std::uint32_t count_{16};
+  for(std::uint32_t i = 0; i < count_; ++i){
+    engine_.create_entity();
+  }
+
+  // components are added in reverse entity order
+  for(std::uint32_t i = count_; i-- > 0;){
+    engine_.add_component<position>(i, position{static_cast<float>(i)});
+    engine_.add_component<name>(i, name{std::to_string(i)});
+  }
+
+  engine_.remove_component<name>(5);
+  engine_.remove_component<position>(7);
+
+  EXPECT_EQ(engine_.get_entity(0).get_data_index<position>(), count_ - 1);
+
+  engine_.compact();
+
+  std::uint32_t expected_index_{0};
+  for(std::uint32_t i = 0; i < count_; ++i){
+    if(engine_.has_component<position>(i)){
+      EXPECT_EQ(engine_.get_entity(i).get_data_index<position>(), expected_index_++);
+      EXPECT_EQ(engine_.get_component<position>(i).x, static_cast<float>(i));
+    }
+    if(engine_.has_component<name>(i)){
+      EXPECT_EQ(engine_.get_component<name>(i).s, std::to_string(i));
+    }
+  }
+
+  auto report_ = engine_.memory_usage();
+  EXPECT_EQ(report_.components[0].size, static_cast<std::size_t>(count_ - 1));
+  EXPECT_EQ(report_.components[0].dead, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.components[1].dead, static_cast<std::size_t>(0));
+
+  // incremental compaction visits one pool per step
+  EXPECT_EQ(engine_.compact_step(), false);
+  EXPECT_EQ(engine_.compact_step(), true);
+
+  // user supplied order
+  engine_.sort_pool<name>([](const name& lhs, const name& rhs){ return lhs.s < rhs.s; });
+
+  std::vector<std::string> by_slot_(count_ - 1);
+  for(std::uint32_t i = 0; i < count_; ++i){
+    if(engine_.has_component<name>(i)){
+      by_slot_[engine_.get_entity(i).get_data_index<name>()] = engine_.get_component<name>(i).s;
+      EXPECT_EQ(engine_.get_component<name>(i).s, std::to_string(i));
+    }
+  }
+  EXPECT_TRUE(std::is_sorted(by_slot_.begin(), by_slot_.end()));
+}
+
+
+TEST(ec_engine_query_tests, ec_engine_query)
+{
+  struct position{
+    float x;
+  };
+
+  struct velocity{
+    float dx;
+  };
+
+  struct frozen{
+    bool b;
+  };
+
+  struct sprite{
+    int id;
+  };
+
+  struct mesh{
+    int id;
+  };
+
+  // Tags
+  struct player_tag{};
+  struct enemy_tag{};
+
+  using components = yaecs::component_list<position, velocity, frozen, sprite, mesh>;
+  using tags = yaecs::tag_list<player_tag, enemy_tag>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  using movable_query = yaecs::query<yaecs::with<position, velocity>, yaecs::without<frozen>, yaecs::any_of<sprite, mesh>>;
+  using movable_traits = yaecs::query_traits<ec_traits_t, movable_query>;
+
+  EXPECT_EQ(movable_traits::with_mask_, (ec_traits_t::component_mask<position, velocity>()));
+  EXPECT_EQ(movable_traits::with_mask_.to_ullong(), 0b00011ull);
+  EXPECT_EQ(movable_traits::without_mask_.to_ullong(), 0b00100ull);
+  EXPECT_EQ(movable_traits::any_of_mask_.to_ullong(), 0b11000ull);
+  static_assert(movable_traits::tag_index_ == -1);
+  static_assert(yaecs::query_traits<ec_traits_t, yaecs::query<yaecs::tagged<enemy_tag>>>::tag_index_ == 1);
+
+  ec_engine_type_t engine_{};
+
+  // 0: matches
+  auto e0 = engine_.create_entity();
+  engine_.add_component<position>(e0, position{0.0f});
+  engine_.add_component<velocity>(e0, velocity{1.0f});
+  engine_.add_component<sprite>(e0, sprite{1});
+
+  // 1: frozen
+  auto e1 = engine_.create_entity();
+  engine_.add_component<position>(e1, position{0.0f});
+  engine_.add_component<velocity>(e1, velocity{1.0f});
+  engine_.add_component<mesh>(e1, mesh{1});
+  engine_.add_component<frozen>(e1, frozen{true});
+
+  // 2: no sprite nor mesh
+  auto e2 = engine_.create_entity();
+  engine_.add_component<position>(e2, position{0.0f});
+  engine_.add_component<velocity>(e2, velocity{1.0f});
+
+  // 3: matches, enemy
+  auto e3 = engine_.create_entity();
+  engine_.add_component<position>(e3, position{0.0f});
+  engine_.add_component<velocity>(e3, velocity{2.0f});
+  engine_.add_component<mesh>(e3, mesh{2});
+  engine_.add_tag<enemy_tag>(e3);
+
+  int visited_{0};
+  engine_.for_query<movable_query>([&](position& pos, velocity& vel){
+    pos.x += vel.dx;
+    ++visited_;
+  });
+
+  EXPECT_EQ(visited_, 2);
+  EXPECT_EQ(engine_.get_component<position>(e0).x, 1.0f);
+  EXPECT_EQ(engine_.get_component<position>(e1).x, 0.0f);
+  EXPECT_EQ(engine_.get_component<position>(e2).x, 0.0f);
+  EXPECT_EQ(engine_.get_component<position>(e3).x, 2.0f);
+
+  visited_ = 0;
+  engine_.for_query<yaecs::query<yaecs::with<position>, yaecs::tagged<enemy_tag>>>([&](position& pos){
+    EXPECT_EQ(pos.x, 2.0f);
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 1);
+
+  visited_ = 0;
+  engine_.for_query<yaecs::query<yaecs::without<frozen, mesh>>>([&](){
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 2);
+}
+
+
+TEST(ec_engine_empty_component_tests, ec_engine_empty_component)
+{
+  struct position{
+    float x;
+  };
+
+  // marker components
+  struct visible{};
+  struct selected{};
+
+  struct health{
+    int hp;
+  };
+
+  struct tag1{};
+
+  using components = yaecs::component_list<visible, position, selected, health>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  static_assert(ec_traits_t::is_empty_component<visible>());
+  static_assert(!ec_traits_t::is_empty_component<position>());
+  static_assert(ec_traits_t::stored_component_count() == 2);
+  static_assert(ec_traits_t::data_index_slot<visible>() == -1);
+  static_assert(ec_traits_t::data_index_slot<position>() == 0);
+  static_assert(ec_traits_t::data_index_slot<health>() == 1);
+
+  using entity_t = yaecs::entity<ec_traits_t>;
+  static_assert(entity_t::data_index_storage_size() == 2 * sizeof(std::uint32_t));
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  for(int i = 0; i < 6; ++i){
+    auto e = engine_.create_entity();
+    engine_.add_component<position>(e, position{static_cast<float>(i)});
+    engine_.add_component<health>(e, health{i});
+    if(i % 2 == 0){
+      engine_.add_component<visible>(e);
+    }
+    if(i % 3 == 0){
+      engine_.add_component<selected>(e, selected{});
+    }
+  }
+
+  auto report_ = engine_.memory_usage();
+  EXPECT_EQ(report_.components[0].size, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.components[0].bytes, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.components[0].live, static_cast<std::size_t>(3));
+  EXPECT_EQ(report_.components[0].dead, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.components[0].element_size, static_cast<std::size_t>(0));
+  EXPECT_EQ(report_.components[2].live, static_cast<std::size_t>(2));
+  EXPECT_EQ(report_.components[1].size, static_cast<std::size_t>(6));
+
+  float sum_{0.0f};
+  engine_.for_matching_entities<visible, position>([&](visible&, position& pos){
+    sum_ += pos.x;
+  });
+  EXPECT_EQ(sum_, 0.0f + 2.0f + 4.0f);
+
+  int visited_{0};
+  engine_.for_query<yaecs::query<yaecs::with<health>, yaecs::with<selected>, yaecs::without<visible>>>([&](health& h, selected&){
+    EXPECT_EQ(h.hp, 3);
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 1);
+
+  engine_.compact();
+  EXPECT_EQ(engine_.get_component<health>(5).hp, 5);
+  EXPECT_EQ(engine_.has_component<visible>(4), true);
+}
+
+
+TEST(ec_engine_static_world_tests, ec_engine_static_world)
+{
+  struct position{
+    float x;
+  };
+
+  struct name{
+    std::string s;
+  };
+
+  struct visible{};
+
+  struct tag1{};
+
+  using components = yaecs::component_list<position, name, visible>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::static_ec_traits<components, tags, 4, 3>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  // an empty engine iterates nothing
+  engine_.for_matching_entities<position>([](position&){ ADD_FAILURE(); });
+  EXPECT_EQ(engine_.memory_usage().components[0].live, static_cast<std::size_t>(0));
+
+  for(int i = 0; i < 4; ++i){
+    EXPECT_NE(engine_.create_entity(), ec_engine_type_t::invalid_entity_id_);
+  }
+  EXPECT_EQ(engine_.create_entity(), ec_engine_type_t::invalid_entity_id_);
+  EXPECT_EQ(engine_.entity_count(), static_cast<std::uint32_t>(4));
+
+  for(std::uint32_t i = 0; i < 3; ++i){
+    EXPECT_TRUE(engine_.add_component<position>(i, position{static_cast<float>(i)}));
+    EXPECT_TRUE(engine_.add_component<name>(i, name{std::to_string(i)}));
+  }
+  EXPECT_FALSE(engine_.can_add_component<position>());
+  EXPECT_FALSE(engine_.add_component<position>(3, position{3.0f}));
+  EXPECT_FALSE(engine_.has_component<position>(3));
+
+  // empty components have no pool, they never run out of capacity
+  for(std::uint32_t i = 0; i < 4; ++i){
+    EXPECT_TRUE(engine_.add_component<visible>(i));
+  }
+
+  float sum_{0.0f};
+  engine_.for_matching_entities<position, name, visible>([&](position& pos, name& n, visible&){
+    EXPECT_EQ(n.s, std::to_string(static_cast<int>(pos.x)));
+    sum_ += pos.x;
+  });
+  EXPECT_EQ(sum_, 3.0f);
+
+  // a dead slot is reclaimed by compaction
+  engine_.remove_component<position>(1);
+  engine_.compact();
+  EXPECT_TRUE(engine_.add_component<position>(3, position{3.0f}));
+  EXPECT_EQ(engine_.get_component<position>(3).x, 3.0f);
+  EXPECT_EQ(engine_.get_component<position>(2).x, 2.0f);
+
+  auto report_ = engine_.memory_usage();
+  EXPECT_EQ(report_.entities.capacity, static_cast<std::size_t>(4));
+  EXPECT_EQ(report_.components[0].capacity, static_cast<std::size_t>(3));
+  EXPECT_EQ(report_.components[1].bytes, 3 * sizeof(name));
+  // links, order and level bounds of up to 4 entities
+  EXPECT_EQ(report_.hierarchy_bytes, 3 * 4 * sizeof(std::uint32_t));
+
+  // a merge that does not fit is refused as a whole
+  using sharded_engine_t = yaecs::sharded_ec_engine<ec_traits_t, 2>;
+  sharded_engine_t sharded_{};
+  for(std::size_t s = 0; s < sharded_engine_t::shard_count(); ++s){
+    for(std::uint32_t i = 0; i < 2; ++i){
+      auto e = sharded_.create_entity(s);
+      sharded_.add_component<position>(e, position{static_cast<float>(s * 2 + i)});
+    }
+  }
+
+  EXPECT_FALSE(sharded_.merge(0, 1));
+  EXPECT_EQ(sharded_.shard(0).entity_count(), static_cast<std::uint32_t>(2));
+  EXPECT_EQ(sharded_.shard(1).entity_count(), static_cast<std::uint32_t>(2));
+  EXPECT_EQ(sharded_.get_component<position>(sharded_engine_t::make_handle(1, 1)).x, 3.0f);
+
+  sharded_.shard(1).remove_component<position>(0);
+  EXPECT_TRUE(sharded_.merge(0, 1));
+  EXPECT_EQ(sharded_.shard(0).entity_count(), static_cast<std::uint32_t>(3));
+  EXPECT_EQ(sharded_.shard(1).entity_count(), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(sharded_.get_component<position>(sharded_engine_t::make_handle(0, 2)).x, 3.0f);
+}
+
+
+TEST(ec_engine_double_buffer_tests, ec_engine_double_buffer)
+{
+  struct transform{
+    float x;
+  };
+
+  struct velocity{
+    float dx;
+  };
+
+  struct tag1{};
+
+  using components = yaecs::component_list<transform, velocity>;
+  using tags = yaecs::tag_list<tag1>;
+  using buffered_components = yaecs::component_list<transform>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags, buffered_components>;
+
+  static_assert(ec_traits_t::is_double_buffered<transform>());
+  static_assert(!ec_traits_t::is_double_buffered<velocity>());
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  for(int i = 0; i < 4; ++i){
+    auto e = engine_.create_entity();
+    engine_.add_component<transform>(e, transform{static_cast<float>(i)});
+    if(i != 2){
+      engine_.add_component<velocity>(e, velocity{1.0f});
+    }
+  }
+
+  for(int tick = 1; tick <= 3; ++tick){
+    // physics writes the current tick while rendering reads the previous one, concurrently
+    std::thread physics_([&](){
+      engine_.for_matching_entities<transform, velocity>([](transform& t, velocity& v){
+        t.x += v.dx;
+      });
+    });
+
+    float previous_sum_{0.0f};
+    engine_.for_matching_entities_previous<transform>([&](const transform& t){
+      previous_sum_ += t.x;
+    });
+
+    physics_.join();
+
+    // 0 + 1 + 2 + 3 at start, 3 moving entities
+    EXPECT_EQ(previous_sum_, 6.0f + 3.0f * static_cast<float>(tick - 1));
+    EXPECT_EQ(engine_.get_previous_component<transform>(0).x, static_cast<float>(tick - 1));
+    EXPECT_EQ(engine_.get_component<transform>(0).x, static_cast<float>(tick));
+
+    engine_.swap_buffers();
+
+    EXPECT_EQ(engine_.get_previous_component<transform>(0).x, static_cast<float>(tick));
+    EXPECT_EQ(engine_.get_previous_component<transform>(2).x, 2.0f);
+  }
+
+  // read only passes leave the slots clean, swap_buffers only copies what was written
+  EXPECT_EQ(engine_.dirty_component_count<transform>(), static_cast<std::size_t>(0));
+  float sum_{0.0f};
+  engine_.for_matching_entities<transform>([&](const transform& t){ sum_ += t.x; });
+  engine_.for_matching_entities<transform, velocity>([&](const transform& t, const velocity&){ sum_ += t.x; });
+  engine_.each<transform>([&](const transform& t){ sum_ += t.x; });
+  engine_.sort_pool<transform>([](const transform& lhs, const transform& rhs){ return lhs.x > rhs.x; });
+  EXPECT_EQ(sum_, 15.0f + 13.0f + 15.0f);
+  EXPECT_EQ(engine_.dirty_component_count<transform>(), static_cast<std::size_t>(0));
+
+  engine_.for_matching_entities<transform, velocity>([](transform& t, const velocity&){ t.x += 0.0f; });
+  EXPECT_EQ(engine_.dirty_component_count<transform>(), static_cast<std::size_t>(3));
+  engine_.swap_buffers();
+
+  // the current buffer starts every tick up to date
+  EXPECT_EQ(engine_.get_component<transform>(3).x, 6.0f);
+
+  engine_.remove_component<transform>(1);
+  engine_.compact();
+  EXPECT_EQ(engine_.get_previous_component<transform>(3).x, 6.0f);
+  EXPECT_EQ(engine_.get_component<transform>(3).x, 6.0f);
+
+  auto report_ = engine_.memory_usage();
+  EXPECT_EQ(report_.components[0].bytes, report_.components[0].capacity * (2 * sizeof(transform) + sizeof(std::uint8_t)));
+  EXPECT_EQ(report_.components[1].bytes, report_.components[1].capacity * sizeof(velocity));
+}
+
+
+TEST(ec_engine_hierarchy_tests, ec_engine_hierarchy)
+{
+  struct transform{
+    float local;
+    float world;
+  };
+
+  struct tag1{};
+
+  using components = yaecs::component_list<transform>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  // children are created before their parents
+  //   4 -> 2 -> 0
+  //     -> 3 -> 1
+  //   5
+  for(int i = 0; i < 6; ++i){
+    auto e = engine_.create_entity();
+    engine_.add_component<transform>(e, transform{static_cast<float>(i + 1), 0.0f});
+  }
+
+  engine_.set_parent(0, 2);
+  engine_.set_parent(1, 3);
+  engine_.set_parent(2, 4);
+  engine_.set_parent(3, 4);
+
+  EXPECT_EQ(engine_.parent(0), static_cast<std::uint32_t>(2));
+  EXPECT_EQ(engine_.parent(4), ec_engine_type_t::invalid_entity_id_);
+
+  // cycles are refused
+  EXPECT_FALSE(engine_.set_parent(4, 0));
+  EXPECT_FALSE(engine_.set_parent(3, 3));
+  EXPECT_EQ(engine_.parent(4), ec_engine_type_t::invalid_entity_id_);
+  EXPECT_EQ(engine_.parent(3), static_cast<std::uint32_t>(4));
+  EXPECT_EQ(engine_.parent_link_count(), static_cast<std::uint32_t>(4));
+
+  // detaching an entity without a parent changes nothing
+  engine_.remove_parent(5);
+  EXPECT_EQ(engine_.parent_link_count(), static_cast<std::uint32_t>(4));
+
+  auto propagate_ = [](transform& t, const transform* parent){
+    t.world = t.local + (parent ? parent->world : 0.0f);
+  };
+
+  engine_.for_each_hierarchical<transform>(propagate_);
+
+  EXPECT_EQ(engine_.get_component<transform>(4).world, 5.0f);
+  EXPECT_EQ(engine_.get_component<transform>(2).world, 8.0f);
+  EXPECT_EQ(engine_.get_component<transform>(0).world, 9.0f);
+  EXPECT_EQ(engine_.get_component<transform>(1).world, 11.0f);
+  EXPECT_EQ(engine_.get_component<transform>(5).world, 6.0f);
+
+  ASSERT_EQ(engine_.update_hierarchy(), static_cast<std::size_t>(3));
+  EXPECT_EQ(engine_.hierarchy_level(0), (std::pair<std::uint32_t, std::uint32_t>{0, 2}));
+  EXPECT_EQ(engine_.hierarchy_level(1), (std::pair<std::uint32_t, std::uint32_t>{2, 4}));
+  EXPECT_EQ(engine_.hierarchy_level(2), (std::pair<std::uint32_t, std::uint32_t>{4, 6}));
+
+  // pools follow the hierarchy order: 4 5 | 2 3 | 0 1
+  engine_.sort_by_hierarchy();
+  EXPECT_EQ(engine_.get_entity(4).get_data_index<transform>(), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(engine_.get_entity(5).get_data_index<transform>(), static_cast<std::uint32_t>(1));
+  EXPECT_EQ(engine_.get_entity(2).get_data_index<transform>(), static_cast<std::uint32_t>(2));
+  EXPECT_EQ(engine_.get_entity(1).get_data_index<transform>(), static_cast<std::uint32_t>(5));
+
+  // reparenting, levels processed one after another, each level split over two threads
+  engine_.set_parent(5, 1);
+  engine_.get_component<transform>(4).local = 10.0f;
+
+  const auto levels_ = engine_.update_hierarchy();
+  EXPECT_EQ(levels_, static_cast<std::size_t>(4));
+  for(std::size_t level = 0; level < levels_; ++level){
+    const auto [begin_, end_] = engine_.hierarchy_level(level);
+    const auto middle_ = begin_ + (end_ - begin_) / 2;
+    std::thread worker_([&, begin = begin_, middle = middle_](){
+      engine_.for_each_hierarchical_range<transform>(begin, middle, propagate_);
+    });
+    engine_.for_each_hierarchical_range<transform>(middle_, end_, propagate_);
+    worker_.join();
+  }
+
+  EXPECT_EQ(engine_.get_component<transform>(0).world, 14.0f);
+  EXPECT_EQ(engine_.get_component<transform>(5).world, 10.0f + 4.0f + 2.0f + 6.0f);
+}
+
+
+TEST(ec_engine_prefab_tests, ec_engine_prefab)
+{
+  struct position{
+    float x;
+    float y;
+  };
+
+  struct name{
+    std::string s;
+  };
+
+  struct unit{};
+
+  struct velocity{
+    float dx;
+  };
+
+  // Tags
+  struct soldier_tag{};
+  struct tower_tag{};
+
+  using components = yaecs::component_list<position, name, unit, velocity>;
+  using tags = yaecs::tag_list<soldier_tag, tower_tag>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+
+  engine_.create_entity();
+  auto proto_ = engine_.create_entity();
+  engine_.add_component<position>(proto_, position{1.0f, 2.0f});
+  engine_.add_component<name>(proto_, name{"soldier"});
+  engine_.add_component<unit>(proto_);
+  engine_.add_tag<tower_tag>(proto_);
+
+  auto prefab_ = engine_.make_prefab(proto_);
+  EXPECT_TRUE(prefab_.has<position>());
+  EXPECT_FALSE(prefab_.has<velocity>());
+  EXPECT_EQ(prefab_.get<name>().s, "soldier");
+  EXPECT_EQ(prefab_.prototype().tag(), 1);
+
+  constexpr std::uint32_t count_{100};
+  auto first_ = engine_.instantiate(prefab_, count_);
+
+  EXPECT_EQ(first_, static_cast<std::uint32_t>(2));
+  EXPECT_EQ(engine_.entity_count(), count_ + 2);
+
+  for(std::uint32_t id = first_; id < first_ + count_; ++id){
+    EXPECT_EQ(engine_.get_entity(id).id(), id);
+    EXPECT_EQ(engine_.get_entity(id).tag(), 1);
+    EXPECT_EQ(engine_.get_entity(id).get_data_index<position>(), id - 1);
+    EXPECT_TRUE(engine_.has_component<unit>(id));
+    EXPECT_FALSE(engine_.has_component<velocity>(id));
+    EXPECT_EQ(engine_.get_component<position>(id).y, 2.0f);
+    EXPECT_EQ(engine_.get_component<name>(id).s, "soldier");
+  }
+
+  // instances are independent
+  engine_.get_component<position>(first_).x = 5.0f;
+  EXPECT_EQ(engine_.get_component<position>(first_ + 1).x, 1.0f);
+
+  // prefabs can also be built without an entity
+  ec_engine_type_t::prefab_t projectile_{};
+  projectile_.set<velocity>(velocity{3.0f});
+  projectile_.set_tag<soldier_tag>();
+  auto projectile_first_ = engine_.instantiate(projectile_, 3);
+
+  int visited_{0};
+  engine_.each_matching_tag<soldier_tag, std::function<void(velocity&)>, velocity>([&](velocity& v){
+    EXPECT_EQ(v.dx, 3.0f);
+    ++visited_;
+  });
+  EXPECT_EQ(visited_, 3);
+  EXPECT_EQ(engine_.get_entity(projectile_first_ + 2).get_data_index<velocity>(), static_cast<std::uint32_t>(2));
+
+  // fixed capacity engines refuse prefabs that do not fit
+  using static_traits_t = yaecs::static_ec_traits<components, tags, 8, 4>;
+  yaecs::ec_engine<static_traits_t> static_engine_{};
+  yaecs::ec_engine<static_traits_t>::prefab_t tower_{};
+  tower_.set<position>(position{0.0f, 0.0f});
+
+  EXPECT_EQ(static_engine_.instantiate(tower_, 5), yaecs::ec_engine<static_traits_t>::invalid_entity_id_);
+  EXPECT_EQ(static_engine_.entity_count(), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(static_engine_.instantiate(tower_, 4), static_cast<std::uint32_t>(0));
+  EXPECT_EQ(static_engine_.get_component<position>(3).x, 0.0f);
+
+  // spawning in small batches grows the entity table geometrically
+  ec_engine_type_t batches_{};
+  std::size_t reallocations_{0};
+  std::size_t capacity_{batches_.memory_usage().entities.capacity};
+  for(std::uint32_t i = 0; i < 1000; ++i){
+    EXPECT_EQ(batches_.instantiate(prefab_, 2), 2 * i);
+    const auto new_capacity_ = batches_.memory_usage().entities.capacity;
+    reallocations_ += new_capacity_ != capacity_ ? 1u : 0u;
+    capacity_ = new_capacity_;
+  }
+  EXPECT_EQ(batches_.entity_count(), static_cast<std::uint32_t>(2000));
+  EXPECT_LE(reallocations_, static_cast<std::size_t>(12));
+  EXPECT_EQ(batches_.get_component<name>(1999).s, "soldier");
+  EXPECT_EQ(batches_.get_entity(1999).get_data_index<position>(), static_cast<std::uint32_t>(1999));
+}
+
+
+TEST(ec_engine_concurrent_load_tests, ec_engine_concurrent_load)
+{
+  struct position{
+    float x;
+  };
+
+  struct name{
+    std::string s;
+  };
+
+  struct loaded{};
+
+  struct tag1{};
+
+  using components = yaecs::component_list<position, name, loaded>;
+  using tags = yaecs::tag_list<tag1>;
+
+  using ec_traits_t = yaecs::ec_traits<components, tags>;
+
+  using ec_engine_type_t = yaecs::ec_engine<ec_traits_t>;
+
+  ec_engine_type_t engine_{};
+  auto existing_ = engine_.create_entity();
+  engine_.add_component<position>(existing_, position{-1.0f});
+
+  constexpr std::size_t thread_count_{4};
+  constexpr std::uint32_t per_thread_{250};
+
+  // more ids are reserved than used, the rest is released by commit
+  auto loader_ = engine_.begin_concurrent_load(thread_count_ * per_thread_ + 100, thread_count_);
+
+  std::vector<std::thread> threads_{};
+  for(std::size_t t = 0; t < thread_count_; ++t){
+    threads_.emplace_back([&loader_, t](){
+      auto& stage_ = loader_.get_stage(t);
+      for(std::uint32_t i = 0; i < per_thread_; ++i){
+        auto e = stage_.create_entity();
+        stage_.add_component<position>(e, position{static_cast<float>(e)});
+        stage_.add_component<loaded>(e, loaded{});
+        if(i % 2 == 0){
+          stage_.add_component<name>(e, name{std::to_string(e)});
+        }
+      }
+    });
+  }
+  for(std::thread& thread_ : threads_){
+    thread_.join();
+  }
+
+  EXPECT_TRUE(loader_.commit());
+  EXPECT_EQ(engine_.entity_count(), thread_count_ * per_thread_ + 1);
+
+  std::size_t loaded_count_{0};
+  engine_.for_matching_entities<position, loaded>([&](position&, loaded&){
+    ++loaded_count_;
+  });
+  EXPECT_EQ(loaded_count_, thread_count_ * per_thread_);
+
+  std::size_t named_count_{0};
+  for(std::uint32_t id = 1; id < engine_.entity_count(); ++id){
+    EXPECT_EQ(engine_.get_component<position>(id).x, static_cast<float>(id));
+    if(engine_.has_component<name>(id)){
+      EXPECT_EQ(engine_.get_component<name>(id).s, std::to_string(id));
+      ++named_count_;
+    }
+  }
+  EXPECT_EQ(named_count_, thread_count_ * per_thread_ / 2);
+  EXPECT_EQ(engine_.get_component<position>(existing_).x, -1.0f);
+
+  // the engine is usable as usual afterwards
+  EXPECT_EQ(engine_.create_entity(), thread_count_ * per_thread_ + 1);
+
+  // streaming small zones grows the entity table geometrically
+  std::size_t reallocations_{0};
+  std::size_t capacity_{engine_.memory_usage().entities.capacity};
+  for(std::uint32_t zone = 0; zone < 200; ++zone){
+    auto zone_loader_ = engine_.begin_concurrent_load(5, 1);
+    for(std::uint32_t i = 0; i < 5; ++i){
+      auto e = zone_loader_.get_stage(0).create_entity();
+      zone_loader_.get_stage(0).add_component<position>(e, position{static_cast<float>(zone)});
+    }
+    EXPECT_TRUE(zone_loader_.commit());
+
+    const auto new_capacity_ = engine_.memory_usage().entities.capacity;
+    reallocations_ += new_capacity_ != capacity_ ? 1u : 0u;
+    capacity_ = new_capacity_;
+  }
+  EXPECT_EQ(engine_.entity_count(), thread_count_ * per_thread_ + 2 + 1000);
+  EXPECT_LE(reallocations_, static_cast<std::size_t>(4));
+  EXPECT_EQ(engine_.get_component<position>(engine_.entity_count() - 1).x, 199.0f);
+
+  // caller owned workers publish the pools
+  const auto first_ = engine_.entity_count();
+  auto big_loader_ = engine_.begin_concurrent_load(ec_engine_type_t::concurrent_loader_t::parallel_publish_threshold_, 1);
+  for(std::size_t i = 0; i < ec_engine_type_t::concurrent_loader_t::parallel_publish_threshold_; ++i){
+    auto e = big_loader_.get_stage(0).create_entity();
+    big_loader_.get_stage(0).add_component<position>(e, position{static_cast<float>(e)});
+    big_loader_.get_stage(0).add_component<name>(e, name{std::to_string(e)});
+  }
+
+  std::vector<std::thread> workers_{};
+  std::vector<std::size_t> pools_{};
+  EXPECT_TRUE(big_loader_.commit([&](std::size_t pool_index, auto task){
+    pools_.push_back(pool_index);
+    workers_.emplace_back(task);
+  }));
+  for(std::thread& worker_ : workers_){
+    worker_.join();
+  }
+  EXPECT_EQ(pools_, (std::vector<std::size_t>{0, 1}));
+  EXPECT_EQ(engine_.get_component<name>(first_).s, std::to_string(first_));
+  EXPECT_EQ(engine_.get_component<position>(engine_.entity_count() - 1).x, static_cast<float>(engine_.entity_count() - 1));
+}